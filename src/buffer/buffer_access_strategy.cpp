@@ -0,0 +1,37 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// buffer_access_strategy.cpp
+//
+// Identification: src/buffer/buffer_access_strategy.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/buffer_access_strategy.h"
+
+#include <algorithm>
+
+namespace bustub {
+
+BufferAccessStrategy::BufferAccessStrategy(AccessStrategyType type) : BufferAccessStrategy(type, BULK_READ_RING_SIZE) {}
+
+BufferAccessStrategy::BufferAccessStrategy(AccessStrategyType type, size_t ring_size)
+    : type_(type), ring_size_(ring_size) {
+  BUSTUB_ASSERT(ring_size > 0, "A ring needs at least one frame");
+}
+
+BufferAccessStrategy::Ring *BufferAccessStrategy::GetRing(const void *owner, size_t pool_size) {
+  for (auto &ring : rings_) {
+    if (ring.owner_ == owner) {
+      return &ring;
+    }
+  }
+  size_t ring_size = std::min(std::max(std::min(ring_size_, pool_size / 8), MIN_RING_SIZE), pool_size);
+  rings_.push_back(Ring{owner, std::vector<Slot>(ring_size), 0});
+  return &rings_.back();
+}
+
+}  // namespace bustub
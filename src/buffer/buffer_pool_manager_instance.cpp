@@ -12,38 +12,105 @@
 
 #include "buffer/buffer_pool_manager_instance.h"
 
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <utility>
+
+#include "buffer/clock_replacer.h"
+#include "buffer/lru_k_replacer.h"
+#include "buffer/lru_replacer.h"
 #include "common/macros.h"
 
 namespace bustub {
 
+/** Build the replacer selected by the options. */
+static Replacer *MakeReplacer(const BufferPoolOptions &options, size_t num_pages) {
+  switch (options.replacer_type_) {
+    case ReplacerType::CLOCK:
+      return new ClockReplacer(num_pages);
+    case ReplacerType::LRUK:
+      return new LRUKReplacer(num_pages, options.lru_k_, options.lru_k_correlated_period_);
+    case ReplacerType::LRU:
+      return new LRUReplacer(num_pages);
+  }
+  UNREACHABLE("unknown replacer type");
+}
+
 BufferPoolManagerInstance::BufferPoolManagerInstance(size_t pool_size, DiskManager *disk_manager,
-                                                     LogManager *log_manager)
-    : BufferPoolManagerInstance(pool_size, 1, 0, disk_manager, log_manager) {}
-  
+                                                     LogManager *log_manager, const BufferPoolOptions &options)
+    : BufferPoolManagerInstance(pool_size, 1, 0, disk_manager, log_manager, options) {}
 
 BufferPoolManagerInstance::BufferPoolManagerInstance(size_t pool_size, uint32_t num_instances, uint32_t instance_index,
-                                                     DiskManager *disk_manager, LogManager *log_manager)
+                                                     DiskManager *disk_manager, LogManager *log_manager,
+                                                     const BufferPoolOptions &options)
     : pool_size_(pool_size),
+      max_pool_size_(std::max(pool_size, options.max_pool_size_)),
+      options_(options),
       num_instances_(num_instances),
       instance_index_(instance_index),
       next_page_id_(instance_index),
+      arena_(max_pool_size_, options.huge_pages_),
       disk_manager_(disk_manager),
       log_manager_(log_manager) {
   BUSTUB_ASSERT(num_instances > 0, "If BPI is not part of a pool, then the pool size should just be 1");
   BUSTUB_ASSERT(
       instance_index < num_instances,
       "BPI index cannot be greater than the number of BPIs in the pool. In non-parallel case, index should just be 1.");
-  // We allocate a consecutive memory space for the buffer pool.
-  pages_ = new Page[pool_size_];
-  replacer_ = new LRUReplacer(pool_size);
+  // 页面id按实例条带化，空闲页面也按条带交给各个实例；文件里已有的页面不能再从计数器分配出去
+  disk_manager_->SetNumInstances(num_instances);
+  auto stride = static_cast<page_id_t>(num_instances);
+  auto file_pages = static_cast<page_id_t>((disk_manager_->GetDbFileSize() + PAGE_SIZE - 1) / PAGE_SIZE);
+  page_id_t first_page_id = file_pages - file_pages % stride + static_cast<page_id_t>(instance_index);
+  next_page_id_ = first_page_id < file_pages ? first_page_id + stride : first_page_id;
+  // We allocate a consecutive memory space for the buffer pool. Frames up to max_pool_size_ exist from the start so
+  // that Resize never moves a page; the arena only commits memory for the frames that are touched.
+  if (options_.numa_node_ >= 0) {
+    arena_.BindToNode(options_.numa_node_);
+  }
+  pages_ = new Page[max_pool_size_];
+  for (size_t i = 0; i < max_pool_size_; ++i) {
+    pages_[i].data_ = arena_.GetFrame(static_cast<frame_id_t>(i));
+  }
+  replacer_ = MakeReplacer(options_, max_pool_size_);
 
   // Initially, every page is in the free list.
-  for (size_t i = 0; i < pool_size_; ++i) {
+  for (size_t i = 0; i < pool_size; ++i) {
     free_list_.emplace_back(static_cast<int>(i));
   }
+
+  prefetched_ = std::make_unique<std::atomic<bool>[]>(max_pool_size_);
+  io_in_progress_ = std::make_unique<std::atomic<bool>[]>(max_pool_size_);
+  heat_ = std::make_unique<std::atomic<uint32_t>[]>(max_pool_size_);
+  cache_admissions_ = std::make_unique<CacheAdmission[]>(max_pool_size_);
+  if (options_.compressed_tier_bytes_ > 0) {
+    compressed_tier_ = std::make_unique<CompressedPageTier>(options_.compressed_tier_bytes_);
+  }
+  for (size_t i = 0; i < options_.prefetch_threads_; ++i) {
+    prefetch_threads_.emplace_back(&BufferPoolManagerInstance::PrefetchThreadMain, this);
+  }
+  if (options_.bg_writer_clean_ratio_ > 0) {
+    bg_writer_ = std::thread(&BufferPoolManagerInstance::BackgroundWriterMain, this);
+  }
 }
 
 BufferPoolManagerInstance::~BufferPoolManagerInstance() {
+  {
+    std::scoped_lock lk{prefetch_latch_};
+    stop_prefetch_ = true;
+  }
+  prefetch_cv_.notify_all();
+  for (auto &thread : prefetch_threads_) {
+    thread.join();
+  }
+  if (bg_writer_.joinable()) {
+    {
+      std::scoped_lock lk{bg_writer_latch_};
+      stop_bg_writer_ = true;
+    }
+    bg_writer_cv_.notify_all();
+    bg_writer_.join();
+  }
   delete[] pages_;
   delete replacer_;
 }
@@ -51,74 +118,650 @@ BufferPoolManagerInstance::~BufferPoolManagerInstance() {
 // 刷新目标页面到磁盘
 bool BufferPoolManagerInstance::FlushPgImp(page_id_t page_id) {
   // Make sure you call DiskManager::WritePage!
-  std::scoped_lock lk{latch_};
-  if(page_id == INVALID_PAGE_ID){
+  if (page_id == INVALID_PAGE_ID) {
     return false;
   }
-  auto iter = page_table_.find(page_id);
-  // 如果page不在页表中
-  if(iter == page_table_.end()){
-    return false;
+  // 该页面可能刚被替换出去，还在写回
+  WaitForWriteback(page_id);
+  Page *page = nullptr;
+  bool found = false;
+  // 和后台写线程一样在分片锁下直接pin住，写盘时不持有latch_
+  page_table_.Find(page_id, [this, &page, &found](frame_id_t frame) {
+    found = true;
+    // 正在读入的页面和磁盘上的内容一致
+    if (!io_in_progress_[frame]) {
+      page = &pages_[frame];
+      page->pin_count_ += 1;
+    }
+  });
+  if (page == nullptr) {
+    return found;
   }
-  // 根据frame_id 来获得page对象
-  frame_id_t frame = iter->second;
-  Page *page = &pages_[frame];
-  disk_manager_->WritePage(page_id,page->GetData());
-  page->is_dirty_ = false; // 写入磁盘之后重新设置脏页面
+  // 先清除脏标记再写：写的过程中UnpinPage(page_id, true)设置的脏标记不会丢
+  page->RLatch();
+  page->is_dirty_ = false;
+  disk_manager_->WritePage(page_id, page->GetData());
+  page->RUnlatch();
+  UnpinPgImp(page_id, false);
   return true;
 }
 
 void BufferPoolManagerInstance::FlushAllPgsImp() {
   // You can do it!
+  std::vector<std::pair<page_id_t, BufferPoolManagerInstance *>> dirty_pages;
+  CollectDirtyPages(&dirty_pages);
+  WriteDirtyPages(disk_manager_, &dirty_pages);
+}
+
+void BufferPoolManagerInstance::CollectDirtyPages(
+    std::vector<std::pair<page_id_t, BufferPoolManagerInstance *>> *dirty_pages) {
+  // 被替换出去的脏页面不在页表中，先等它们写完
+  WaitForWriteback(INVALID_PAGE_ID);
+  // 不持有latch_，也不pin：写之前再逐个检查页面是否还在、是否还脏
+  page_table_.ForEach([this, dirty_pages](page_id_t page_id, frame_id_t frame) {
+    if (!io_in_progress_[frame] && pages_[frame].IsDirty()) {
+      dirty_pages->emplace_back(page_id, this);
+    }
+  });
+}
+
+void BufferPoolManagerInstance::WriteDirtyPages(
+    DiskManager *disk_manager, std::vector<std::pair<page_id_t, BufferPoolManagerInstance *>> *dirty_pages) {
+  if (dirty_pages->empty()) {
+    return;
+  }
+  std::sort(dirty_pages->begin(), dirty_pages->end());
+  // 暂存区和帧一样按页对齐，O_DIRECT模式下可以直接写
+  FrameArena staging(FLUSH_BATCH_PAGES, false);
+  std::vector<std::pair<page_id_t, BufferPoolManagerInstance *>> staged;
+  auto write_staged = [disk_manager, &staging, &staged] {
+    if (staged.empty()) {
+      return;
+    }
+    disk_manager->WritePages(staged.front().first, staging.GetFrame(0), staged.size());
+    for (const auto &[page_id, instance] : staged) {
+      instance->EndFlush(page_id);
+    }
+    staged.clear();
+  };
+  for (const auto &[page_id, instance] : *dirty_pages) {
+    // page id相邻的页面合并成一次写
+    if (!staged.empty() && (staged.size() == FLUSH_BATCH_PAGES || page_id != staged.back().first + 1)) {
+      write_staged();
+    }
+    // 页面只在拷贝时pin住，写完之前留在flushing_pages_中，被替换之后再读回的线程会等这次写完。
+    // 阻塞之前先写出暂存的页面：持有某个页面锁的线程可能正在等其中的页面读回
+    bool wait = false;
+    FlushCopyResult result;
+    while ((result = instance->CopyDirtyPage(page_id, staging.GetFrame(static_cast<frame_id_t>(staged.size())),
+                                             wait)) == FlushCopyResult::BUSY) {
+      write_staged();
+      instance->WaitForFlush(page_id);
+      wait = true;
+    }
+    if (result == FlushCopyResult::COPIED) {
+      staged.emplace_back(page_id, instance);
+    }
+  }
+  write_staged();
+  disk_manager->Sync();
+}
+
+BufferPoolManagerInstance::FlushCopyResult BufferPoolManagerInstance::CopyDirtyPage(page_id_t page_id, char *data,
+                                                                                     bool wait) {
+  Page *page = nullptr;
+  // 和后台写线程一样不经过replacer直接pin住，该页面保持在替换顺序中的位置
+  page_table_.Find(page_id, [this, &page](frame_id_t frame) {
+    if (!io_in_progress_[frame] && pages_[frame].IsDirty()) {
+      page = &pages_[frame];
+      page->pin_count_ += 1;
+    }
+  });
+  if (page == nullptr) {
+    return FlushCopyResult::SKIPPED;
+  }
+  FlushCopyResult result = FlushCopyResult::BUSY;
+  if (wait) {
+    page->RLatch();
+  } else if (!page->TryRLatch()) {
+    UnpinPgImp(page_id, false);
+    return result;
+  }
+  if (!page->IsDirty()) {
+    result = FlushCopyResult::SKIPPED;
+  } else {
+    std::scoped_lock lk{io_latch_};
+    // 另一次刷盘拷贝的旧内容还没写完，这次的新内容不能先写
+    if (flushing_pages_.count(page_id) == 0) {
+      flushing_pages_.insert(page_id);
+      result = FlushCopyResult::COPIED;
+    }
+  }
+  if (result == FlushCopyResult::COPIED) {
+    memcpy(data, page->GetData(), PAGE_SIZE);
+    page->is_dirty_ = false;
+  }
+  page->RUnlatch();
+  UnpinPgImp(page_id, false);
+  return result;
+}
+
+bool BufferPoolManagerInstance::FindReplacementFrame(frame_id_t *frame_id, page_id_t *writeback_page_id) {
+  *writeback_page_id = INVALID_PAGE_ID;
+  // 优先从free list中取
+  if (!free_list_.empty()) {
+    *frame_id = free_list_.front();
+    free_list_.pop_front();
+    prefetched_[*frame_id] = false;
+    return true;
+  }
+  frame_id_t frame = -1;
+  while (replacer_->Victim(&frame)) {
+    Page *page = &pages_[frame];
+    page_id_t old_page_id = page->page_id_;
+    // 已被删除的frame在free list中，replacer里只是过期的记录；正在缩容的frame由Resize负责清空
+    if (old_page_id == INVALID_PAGE_ID || static_cast<size_t>(frame) >= pool_size_) {
+      continue;
+    }
+    // 命中路径不持有latch_，可能在Victim之后又pin了该页面，所以要在分片锁下重新检查pin_count_
+    bool evicted = page_table_.EraseIf(
+        old_page_id, [page, frame](frame_id_t cur) { return cur == frame && page->GetPinCount() == 0; });
+    if (!evicted) {
+      continue;
+    }
+    RecordEviction(frame);
+    // 脏页面由调用者在释放latch_之后写回，干净的页面交给二级缓存
+    if (page->IsDirty()) {
+      BeginWriteback(old_page_id);
+      *writeback_page_id = old_page_id;
+    } else {
+      BeginCacheAdmission(frame, old_page_id);
+    }
+    prefetched_[frame] = false;
+    *frame_id = frame;
+    return true;
+  }
+  return false;
+}
+
+bool BufferPoolManagerInstance::TakeRingFrame(BufferAccessStrategy *strategy, frame_id_t *frame_id,
+                                              page_id_t *writeback_page_id) {
+  *writeback_page_id = INVALID_PAGE_ID;
+  auto *ring = strategy->GetRing(this, pool_size_);
+  const auto &slot = ring->slots_[ring->next_];
+  // 环还没填满
+  if (slot.frame_id_ < 0) {
+    return false;
+  }
+  frame_id_t frame = slot.frame_id_;
+  Page *page = &pages_[frame];
+  // 该frame已经被别人替换成了其他页面，或者正在被缩容
+  if (static_cast<size_t>(frame) >= pool_size_ || page->page_id_ != slot.page_id_) {
+    return false;
+  }
+  // 别人正在使用该页面时不能复用
+  bool evicted = page_table_.EraseIf(
+      slot.page_id_, [page, frame](frame_id_t cur) { return cur == frame && page->GetPinCount() == 0; });
+  if (!evicted) {
+    return false;
+  }
+  RecordEviction(frame);
+  replacer_->Remove(frame);
+  if (page->IsDirty()) {
+    BeginWriteback(slot.page_id_);
+    *writeback_page_id = slot.page_id_;
+  } else {
+    BeginCacheAdmission(frame, slot.page_id_);
+  }
+  prefetched_[frame] = false;
+  *frame_id = frame;
+  return true;
+}
+
+void BufferPoolManagerInstance::PutRingFrame(BufferAccessStrategy *strategy, frame_id_t frame_id, page_id_t page_id) {
+  auto *ring = strategy->GetRing(this, pool_size_);
+  ring->slots_[ring->next_] = {frame_id, page_id};
+  ring->next_ = (ring->next_ + 1) % ring->slots_.size();
+}
+
+void BufferPoolManagerInstance::AdoptRingFrame(BufferAccessStrategy *strategy, frame_id_t frame_id,
+                                               page_id_t page_id) {
+  frame_id_t recycled = -1;
+  page_id_t writeback_page_id = INVALID_PAGE_ID;
+  {
+    auto lk = LockLatch();
+    // 环的大小不变：最老的frame还给free list，预读的frame进入环
+    bool taken = TakeRingFrame(strategy, &recycled, &writeback_page_id);
+    PutRingFrame(strategy, frame_id, page_id);
+    if (!taken) {
+      return;
+    }
+  }
+  FinishWriteback(recycled, writeback_page_id);
+  auto lk = LockLatch();
+  Page *page = &pages_[recycled];
+  page->page_id_ = INVALID_PAGE_ID;
+  page->is_dirty_ = false;
+  ReturnFrame(recycled);
+}
+
+void BufferPoolManagerInstance::ReturnFrame(frame_id_t frame_id) {
+  // 正在缩容的frame不再放回free list
+  if (static_cast<size_t>(frame_id) < pool_size_) {
+    free_list_.push_back(frame_id);
+  }
+}
+
+bool BufferPoolManagerInstance::Resize(size_t new_pool_size, std::chrono::milliseconds timeout) {
+  if (new_pool_size == 0 || new_pool_size > max_pool_size_) {
+    return false;
+  }
+  std::scoped_lock resize_lk{resize_latch_};
+  auto lk = LockLatch();
+  size_t old_pool_size = pool_size_;
+  if (new_pool_size >= old_pool_size) {
+    for (size_t i = old_pool_size; i < new_pool_size; ++i) {
+      free_list_.emplace_back(static_cast<int>(i));
+    }
+    pool_size_ = new_pool_size;
+    return true;
+  }
+
+  // 从此不再有页面被放入要退役的frame
+  pool_size_ = new_pool_size;
+  free_list_.remove_if([new_pool_size](frame_id_t frame) { return static_cast<size_t>(frame) >= new_pool_size; });
+  auto deadline = std::chrono::steady_clock::now() + timeout;
+  while (!DrainFrames(new_pool_size, old_pool_size)) {
+    if (std::chrono::steady_clock::now() >= deadline) {
+      // 还有页面没有unpin，放弃缩容：已经清空的frame放回free list，还有页面的frame重新交给replacer
+      pool_size_ = old_pool_size;
+      for (size_t i = new_pool_size; i < old_pool_size; ++i) {
+        auto frame = static_cast<frame_id_t>(i);
+        if (pages_[i].page_id_ == INVALID_PAGE_ID) {
+          free_list_.push_back(frame);
+        } else if (pages_[i].GetPinCount() == 0) {
+          replacer_->Unpin(frame);
+        }
+      }
+      return false;
+    }
+    // 等待其他线程unpin这些frame
+    lk.unlock();
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    lk.lock();
+  }
+
+  // 把退役frame占用的内存还给操作系统
+  arena_.Release(new_pool_size, old_pool_size);
+  return true;
+}
+
+bool BufferPoolManagerInstance::DrainFrames(size_t begin, size_t end) {
+  bool drained = true;
+  for (size_t i = begin; i < end; ++i) {
+    auto frame = static_cast<frame_id_t>(i);
+    Page *page = &pages_[frame];
+    page_id_t page_id = page->page_id_;
+    if (page_id == INVALID_PAGE_ID) {
+      continue;
+    }
+    bool evicted = page_table_.EraseIf(
+        page_id, [page, frame](frame_id_t cur) { return cur == frame && page->GetPinCount() == 0; });
+    if (!evicted) {
+      // 页面被pin住，或者该frame正在被写回
+      drained = false;
+      continue;
+    }
+    RecordEviction(frame);
+    replacer_->Remove(frame);
+    // 缩容很少发生，直接在latch_下写回
+    if (page->IsDirty()) {
+      disk_manager_->WritePage(page_id, page->GetData());
+    }
+    page->page_id_ = INVALID_PAGE_ID;
+    page->is_dirty_ = false;
+    prefetched_[frame] = false;
+  }
+  return drained;
+}
+
+BufferPoolStats BufferPoolManagerInstance::GetStats() {
+  BufferPoolStats stats;
+  stats.hits_ = hits_.Sum();
+  stats.misses_ = misses_.Sum();
+  stats.evictions_ = evictions_;
+  stats.sync_writes_ = sync_eviction_writes_;
+  stats.bg_writes_ = bg_writes_;
+  stats.latch_waits_ = latch_waits_.Sum();
+  stats.latch_wait_ns_ = latch_wait_ns_.Sum();
+  for (size_t i = 0; i < BufferPoolStats::HEAT_BUCKETS; ++i) {
+    stats.heat_histogram_[i] = evicted_heat_[i];
+  }
+  // 不计入latch_的等待时间；frame的page_id_在latch_下才稳定
   std::scoped_lock lk{latch_};
-  auto iter = page_table_.begin();
-  while(iter != page_table_.end()){
-    page_id_t page_id = iter->first;
-    frame_id_t frame = iter->second;
+  for (size_t i = 0; i < pool_size_; ++i) {
+    if (pages_[i].page_id_ != INVALID_PAGE_ID) {
+      stats.heat_histogram_[BufferPoolStats::HeatBucket(heat_[i])]++;
+    }
+  }
+  return stats;
+}
+
+std::unique_lock<std::mutex> BufferPoolManagerInstance::LockLatch() {
+  // 没有竞争时不读时钟
+  std::unique_lock lk{latch_, std::try_to_lock};
+  if (!lk.owns_lock()) {
+    auto start = std::chrono::steady_clock::now();
+    lk.lock();
+    latch_waits_.Add();
+    latch_wait_ns_.Add(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count());
+  }
+  return lk;
+}
+
+void BufferPoolManagerInstance::RecordAccess(frame_id_t frame_id) {
+  if (options_.stats_sample_interval_ == 0) {
+    return;
+  }
+  // 每个线程各自计数，采样不写共享的cache line
+  static thread_local size_t fetches = 0;
+  if (++fetches % options_.stats_sample_interval_ == 0) {
+    heat_[frame_id].fetch_add(1, std::memory_order_relaxed);
+  }
+}
+
+void BufferPoolManagerInstance::RecordEviction(frame_id_t frame_id) {
+  evictions_.fetch_add(1, std::memory_order_relaxed);
+  uint32_t heat = heat_[frame_id].exchange(0, std::memory_order_relaxed);
+  evicted_heat_[BufferPoolStats::HeatBucket(heat)].fetch_add(1, std::memory_order_relaxed);
+}
+
+void BufferPoolManagerInstance::BeginWriteback(page_id_t page_id) {
+  std::scoped_lock lk{io_latch_};
+  writeback_pages_.insert(page_id);
+}
+
+void BufferPoolManagerInstance::EndWriteback(page_id_t page_id) {
+  {
+    std::scoped_lock lk{io_latch_};
+    // 同一个页面可能有多次写回，只去掉这一次的
+    auto iter = writeback_pages_.find(page_id);
+    if (iter != writeback_pages_.end()) {
+      writeback_pages_.erase(iter);
+    }
+  }
+  io_cv_.notify_all();
+}
+
+bool BufferPoolManagerInstance::IsUnderWriteback(page_id_t page_id) {
+  std::scoped_lock lk{io_latch_};
+  return writeback_pages_.count(page_id) != 0;
+}
+
+void BufferPoolManagerInstance::EndFlush(page_id_t page_id) {
+  {
+    std::scoped_lock lk{io_latch_};
+    flushing_pages_.erase(page_id);
+  }
+  io_cv_.notify_all();
+}
+
+void BufferPoolManagerInstance::WaitForFlush(page_id_t page_id) {
+  std::unique_lock lk{io_latch_};
+  io_cv_.wait(lk, [this, page_id] { return flushing_pages_.count(page_id) == 0; });
+}
+
+bool BufferPoolManagerInstance::IsFlushing(page_id_t page_id) {
+  std::scoped_lock lk{io_latch_};
+  return flushing_pages_.count(page_id) != 0;
+}
+
+void BufferPoolManagerInstance::BeginCacheAdmission(frame_id_t frame_id, page_id_t page_id) {
+  CacheAdmission &admission = cache_admissions_[frame_id];
+  LocalPageCache *cache = disk_manager_->GetPageCache();
+  if (cache != nullptr) {
+    admission.page_id_ = page_id;
+    admission.ticket_ = cache->BeginAdmit(page_id);
+  }
+  // 放入压缩层之前不能从磁盘读回，否则压缩层里会留下一份过期的副本
+  if (compressed_tier_ != nullptr) {
+    BeginWriteback(page_id);
+    admission.page_id_ = page_id;
+    admission.compress_ = true;
+  }
+}
+
+void BufferPoolManagerInstance::FinishWriteback(frame_id_t frame_id, page_id_t page_id) {
+  CacheAdmission &admission = cache_admissions_[frame_id];
+  const char *data = pages_[frame_id].GetData();
+  if (admission.ticket_ != 0) {
+    // 干净的页面和磁盘上一致，写入二级缓存；期间被修改写回的页面由缓存自己丢弃
+    disk_manager_->GetPageCache()->FinishAdmit(admission.page_id_, data, admission.ticket_);
+  }
+  if (admission.compress_) {
+    compressed_tier_->Put(admission.page_id_, data);
+    EndWriteback(admission.page_id_);
+  }
+  admission = CacheAdmission();
+  if (page_id == INVALID_PAGE_ID) {
+    return;
+  }
+  // 刷盘拷贝之后页面又被修改，新内容要在刷盘的旧内容之后写
+  WaitForFlush(page_id);
+  disk_manager_->WritePage(page_id, data);
+  sync_eviction_writes_++;
+  // 写回之后和磁盘一致，同样放入压缩层
+  if (compressed_tier_ != nullptr) {
+    compressed_tier_->Put(page_id, data);
+  }
+  EndWriteback(page_id);
+}
+
+void BufferPoolManagerInstance::WaitForWriteback(page_id_t page_id) {
+  std::unique_lock lk{io_latch_};
+  io_cv_.wait(lk, [this, page_id] {
+    if (page_id == INVALID_PAGE_ID) {
+      return writeback_pages_.empty() && flushing_pages_.empty();
+    }
+    return writeback_pages_.count(page_id) == 0 && flushing_pages_.count(page_id) == 0;
+  });
+}
+
+void BufferPoolManagerInstance::WaitForIo(frame_id_t frame_id) {
+  if (!io_in_progress_[frame_id]) {
+    return;
+  }
+  std::unique_lock lk{io_latch_};
+  io_cv_.wait(lk, [this, frame_id] { return !io_in_progress_[frame_id]; });
+}
+
+void BufferPoolManagerInstance::FinishIo(frame_id_t frame_id) {
+  {
+    std::scoped_lock lk{io_latch_};
+    io_in_progress_[frame_id] = false;
+  }
+  io_cv_.notify_all();
+}
+
+void BufferPoolManagerInstance::LoadFrame(frame_id_t frame_id, page_id_t page_id, page_id_t writeback_page_id) {
+  // 先写回自己替换出去的页面再等待别人，不会互相等待
+  FinishWriteback(frame_id, writeback_page_id);
+  // 要读的页面可能刚被别的线程替换出去，等它写回之后再读
+  WaitForWriteback(page_id);
+  // 压缩层是独占的：取出之后该页面只存在于frame中
+  if (compressed_tier_ == nullptr || !compressed_tier_->Take(page_id, pages_[frame_id].GetData())) {
+    disk_manager_->ReadPage(page_id, pages_[frame_id].GetData());
+  }
+  FinishIo(frame_id);
+}
+
+void BufferPoolManagerInstance::PrefetchPgImp(page_id_t page_id) {
+  if (page_id == INVALID_PAGE_ID || prefetch_threads_.empty()) {
+    return;
+  }
+  ValidatePageId(page_id);
+  frame_id_t frame = -1;
+  if (page_table_.Find(page_id, &frame)) {
+    return;
+  }
+  {
+    std::scoped_lock lk{prefetch_latch_};
+    // 预读只是提示，队列满了直接丢弃
+    if (prefetch_queue_.size() >= pool_size_) {
+      return;
+    }
+    prefetch_queue_.push_back(page_id);
+  }
+  prefetch_cv_.notify_one();
+}
+
+void BufferPoolManagerInstance::PrefetchThreadMain() {
+  while (true) {
+    page_id_t page_id;
+    {
+      std::unique_lock lk{prefetch_latch_};
+      prefetch_cv_.wait(lk, [this] { return stop_prefetch_ || !prefetch_queue_.empty(); });
+      if (stop_prefetch_) {
+        return;
+      }
+      page_id = prefetch_queue_.front();
+      prefetch_queue_.pop_front();
+    }
+    InstallPrefetchedPage(page_id);
+  }
+}
+
+void BufferPoolManagerInstance::InstallPrefetchedPage(page_id_t page_id) {
+  frame_id_t frame = -1;
+  page_id_t writeback_page_id = INVALID_PAGE_ID;
+  {
+    auto lk = LockLatch();
+    // 排队期间可能已经被读入；所有frame都被pin住时放弃预读
+    if (page_table_.Find(page_id, &frame) || !FindReplacementFrame(&frame, &writeback_page_id)) {
+      return;
+    }
+    // 读盘期间由预读线程pin住该页面；不通知replacer，预读不算一次访问
+    Page *page = &pages_[frame];
+    page->page_id_ = page_id;
+    page->pin_count_ = 1;
+    page->is_dirty_ = false;
+    io_in_progress_[frame] = true;
+    prefetched_[frame] = true;
+    page_table_.Insert(page_id, frame);
+    replacer_->SetPage(frame, page_id, false);
+  }
+  LoadFrame(frame, page_id, writeback_page_id);
+  // pin_count_减到0时该页面进入replacer
+  UnpinPgImp(page_id, false);
+}
+
+void BufferPoolManagerInstance::BackgroundWriterMain() {
+  std::unique_lock lk{bg_writer_latch_};
+  while (!bg_writer_cv_.wait_for(lk, options_.bg_writer_interval_, [this] { return stop_bg_writer_; })) {
+    lk.unlock();
+    CleanVictimCandidates();
+    lk.lock();
+  }
+}
+
+void BufferPoolManagerInstance::CleanVictimCandidates() {
+  std::vector<std::pair<page_id_t, frame_id_t>> dirty_pages;
+  {
+    // 只在挑选页面时持有latch_，写盘时不持有
+    auto lk = LockLatch();
+    auto num_candidates = static_cast<size_t>(std::ceil(options_.bg_writer_clean_ratio_ * replacer_->Size()));
+    std::vector<frame_id_t> candidates;
+    replacer_->PeekVictims(num_candidates, &candidates);
+    for (frame_id_t frame : candidates) {
+      Page *page = &pages_[frame];
+      page_id_t page_id = page->page_id_;
+      if (page_id == INVALID_PAGE_ID || !page->IsDirty()) {
+        continue;
+      }
+      // 不经过replacer直接pin住，写回期间该frame不会被替换
+      bool pinned = false;
+      page_table_.Find(page_id, [page, frame, &pinned](frame_id_t cur) {
+        if (cur == frame) {
+          page->pin_count_ += 1;
+          pinned = true;
+        }
+      });
+      if (pinned) {
+        dirty_pages.emplace_back(page_id, frame);
+      }
+    }
+  }
+  // 按page id顺序写，尽量顺序I/O
+  std::sort(dirty_pages.begin(), dirty_pages.end());
+  for (const auto &[page_id, frame] : dirty_pages) {
     Page *page = &pages_[frame];
-    disk_manager_->WritePage(page_id, page->GetData());
-    iter ++;
+    page->RLatch();
+    // 刷盘拷贝的旧内容还没写完的页面留给下一轮，不能抢在它前面写
+    if (page->IsDirty() && !IsFlushing(page_id)) {
+      disk_manager_->WritePage(page_id, page->GetData());
+      page->is_dirty_ = false;
+      bg_writes_++;
+    }
+    page->RUnlatch();
+    UnpinPgImp(page_id, false);
   }
 }
 
-Page *BufferPoolManagerInstance::NewPgImp(page_id_t *page_id) {
+Page *BufferPoolManagerInstance::NewPgImp(page_id_t *page_id) { return NewPgStrategyImp(page_id, nullptr); }
+
+Page *BufferPoolManagerInstance::NewPgStrategyImp(page_id_t *page_id, BufferAccessStrategy *strategy) {
   // 0.   Make sure you call AllocatePage!
   // 1.   If all the pages in the buffer pool are pinned, return nullptr.
   // 2.   Pick a victim page P from either the free list or the replacer. Always pick from the free list first.
   // 3.   Update P's metadata, zero out memory and add P to the page table.
   // 4.   Set the page ID output parameter. Return a pointer to P.
-  std::scoped_lock lk{latch_};
   frame_id_t frame = -1;
-  Page *page = nullptr;
-  // 如果freelist中就去replacer中找，没有返回nullptr
-  if(!free_list_.empty()){
-    frame = free_list_.front();
-    free_list_.pop_front();
-    page = &pages_[frame];
-  } else if(replacer_->Victim(&frame)) {
-    page = &pages_[frame];
-    if(page->IsDirty()){
-      disk_manager_->WritePage(page->GetPageId(), page->GetData());
+  page_id_t writeback_page_id = INVALID_PAGE_ID;
+  // 复用空闲页面时可能要写空闲页面文件，在拿latch_之前分配，不挡住其他线程的缺页
+  bool reused = false;
+  page_id_t new_page_id = AllocatePage(&reused);
+  {
+    auto lk = LockLatch();
+    // 批量操作先复用自己环中的frame，否则如果freelist中就去replacer中找，没有返回nullptr
+    bool from_ring = strategy != nullptr && TakeRingFrame(strategy, &frame, &writeback_page_id);
+    if (!from_ring && !FindReplacementFrame(&frame, &writeback_page_id)) {
+      lk.unlock();
+      // 分配到的id还回空闲列表，下一次NewPage会再拿到它
+      DeallocatePage(new_page_id);
+      return nullptr;
     }
-    page_table_.erase(page->GetPageId());
-  } else {
-    return nullptr;
+    if (strategy != nullptr) {
+      PutRingFrame(strategy, frame, new_page_id);
+    }
+    Page *page = &pages_[frame];
+    page->page_id_ = new_page_id;
+    page->pin_count_ = 1;
+    // 复用的页面在文件里还有被删除页面的内容，置脏保证清零后的内容会写回，之后不会读到旧内容
+    page->is_dirty_ = reused;
+    io_in_progress_[frame] = true;
+
+    // 将申请到的page添加到page_table中，pin该页面并返回数据
+    page_table_.Insert(new_page_id, frame);
+    replacer_->SetPage(frame, new_page_id, true);
+    replacer_->Pin(frame);
+  }
+  // 旧页面写回之后才能清空内存
+  Page *page = &pages_[frame];
+  FinishWriteback(frame, writeback_page_id);
+  // 和LoadFrame一样：复用的id上可能还有被删除页面的写回没有落定
+  if (reused) {
+    WaitForWriteback(new_page_id);
   }
-  page_id_t new_page_id = AllocatePage();
-  page->page_id_ = new_page_id;
-  page->pin_count_ = 1;
-  page->is_dirty_ = false;
   page->ResetMemory();
-
-  // 将申请到的page添加到page_table中，pin该页面并返回数据
-  page_table_[new_page_id] = frame;
+  FinishIo(frame);
   *page_id = new_page_id;
-  replacer_->Pin(frame);
-  return page; 
-  
+  return page;
 }
 //从缓冲池中获取请求的页面
-Page *BufferPoolManagerInstance::FetchPgImp(page_id_t page_id) {
+Page *BufferPoolManagerInstance::FetchPgImp(page_id_t page_id) { return FetchPgStrategyImp(page_id, nullptr); }
+
+Page *BufferPoolManagerInstance::FetchPgStrategyImp(page_id_t page_id, BufferAccessStrategy *strategy) {
   // 1.     Search the page table for the requested page (P).
   // 1.1    If P exists, pin it and return it immediately.
   // 1.2    If P does not exist, find a replacement page (R) from either the free list or the replacer.
@@ -126,39 +769,62 @@ Page *BufferPoolManagerInstance::FetchPgImp(page_id_t page_id) {
   // 2.     If R is dirty, write it back to the disk.
   // 3.     Delete R from the page table and insert P.
   // 4.     Update P's metadata, read in the page content from disk, and then return a pointer to P.」
-  std::scoped_lock lk{latch_};
-  auto iter = page_table_.find(page_id);
-  if(iter != page_table_.end()){
-    frame_id_t frame = iter->second;
-    Page *page = &pages_[frame];
-    page->pin_count_ += 1;
+  frame_id_t frame = -1;
+  auto pin = [this, &frame](frame_id_t cur) {
+    frame = cur;
+    pages_[cur].pin_count_ += 1;
+  };
+  auto hit = [this, &frame, page_id, strategy] {
+    hits_.Add();
+    RecordAccess(frame);
     replacer_->Pin(frame);
-    return page;
+    // 页面可能还在由别的线程读入
+    WaitForIo(frame);
+    // 先读再交换，避免每次命中都写共享的cache line
+    if (prefetched_[frame].load(std::memory_order_relaxed) && prefetched_[frame].exchange(false) &&
+        strategy != nullptr) {
+      AdoptRingFrame(strategy, frame, page_id);
+    }
+    return &pages_[frame];
+  };
+  // 命中时只持有页表的分片锁
+  if (page_table_.Find(page_id, pin)) {
+    return hit();
   }
-  frame_id_t frame = -1;
-  Page *page = nullptr;
-  if(!free_list_.empty()){
-    frame = free_list_.front();
-    free_list_.pop_front();
-    page = &pages_[frame];
-  } else if(replacer_->Victim(&frame)){
-    page = &pages_[frame];
-    if(page->IsDirty()){
-      disk_manager_->WritePage(page->GetPageId(), page->GetData());
+
+  page_id_t writeback_page_id = INVALID_PAGE_ID;
+  bool resident = false;
+  {
+    auto lk = LockLatch();
+    // 等待latch_期间其他线程可能已经读入了该页面；hit()可能要拿latch_，所以在释放latch_之后再调用
+    resident = page_table_.Find(page_id, pin);
+    if (!resident) {
+      misses_.Add();
+      bool from_ring = strategy != nullptr && TakeRingFrame(strategy, &frame, &writeback_page_id);
+      if (!from_ring && !FindReplacementFrame(&frame, &writeback_page_id)) {
+        return nullptr;
+      }
+      if (strategy != nullptr) {
+        PutRingFrame(strategy, frame, page_id);
+      }
+      Page *page = &pages_[frame];
+      page->page_id_ = page_id;
+      page->pin_count_ = 1;
+      page->is_dirty_ = false;
+      // 先放入页表再读盘：同一页面的其他访问者命中后等待读完，不会重复读入
+      io_in_progress_[frame] = true;
+      page_table_.Insert(page_id, frame);
+      replacer_->SetPage(frame, page_id, false);
+      replacer_->Pin(frame);
     }
-    page_table_.erase(page->GetPageId());
-  } else {
-    return nullptr;
   }
-  page->page_id_ = page_id;
-  page->pin_count_ = 1;
-  page->is_dirty_ = false;
-  // 
-  disk_manager_->ReadPage(page_id, page->GetData());
-  //new出后添加到pg_table,pin该page
-  page_table_[page_id] = frame;
-  replacer_->Pin(frame);
-  return page;
+  if (resident) {
+    return hit();
+  }
+  // 读写磁盘时不持有latch_
+  LoadFrame(frame, page_id, writeback_page_id);
+  RecordAccess(frame);
+  return &pages_[frame];
 }
 
 bool BufferPoolManagerInstance::DeletePgImp(page_id_t page_id) {
@@ -167,55 +833,94 @@ bool BufferPoolManagerInstance::DeletePgImp(page_id_t page_id) {
   // 1.   If P does not exist, return true.
   // 2.   If P exists, but has a non-zero pin-count, return false. Someone is using the page.
   // 3.   Otherwise, P can be deleted. Remove P from the page table, reset its metadata and return it to the free list.
-  std::scoped_lock lk{latch_};
-  auto iter = page_table_.find(page_id);
-  if(iter == page_table_.end()){
+  // 刚被替换出去的页面可能还在写回或者放入压缩层，等它落定之后再释放，否则复用这个id的页面会被旧内容覆盖
+  WaitForWriteback(page_id);
+  auto lk = LockLatch();
+  frame_id_t frame = -1;
+  bool pinned = false;
+  bool erased = page_table_.EraseIf(page_id, [this, &frame, &pinned](frame_id_t cur) {
+    frame = cur;
+    pinned = pages_[cur].GetPinCount() > 0;  // 该页面已经被其他页面占用
+    return !pinned;
+  });
+  if (!erased) {
+    if (pinned) {
+      return false;
+    }
+    // 等待之后、拿到latch_之前该页面又被替换出去了：不持有latch_重新等
+    if (IsUnderWriteback(page_id)) {
+      lk.unlock();
+      return DeletePgImp(page_id);
+    }
+    // 不在缓冲池中的页面可能还在压缩层里
+    if (compressed_tier_ != nullptr) {
+      compressed_tier_->Erase(page_id);
+    }
+    DeallocatePage(page_id);
     return true;
   }
-  frame_id_t frame = iter->second;
   Page *page = &pages_[frame];
-  if(page->GetPinCount() > 0 ){ // 该页面已经被其他页面占用
-    return false;
-  }
-  if(page->IsDirty()){
+  if (page->IsDirty()) {
     disk_manager_->WritePage(page->GetPageId(), page->GetData());
+  } else if (disk_manager_->GetPageCache() != nullptr) {
+    disk_manager_->GetPageCache()->Invalidate(page_id);
   }
-  replacer_->Pin(frame);
-  page_table_.erase(page->page_id_);
+  replacer_->Remove(frame);
+  prefetched_[frame] = false;
+  heat_[frame] = 0;
   page->is_dirty_ = false;
   page->pin_count_ = 0;
   page->page_id_ = INVALID_PAGE_ID;
   page->ResetMemory();
-  free_list_.push_back(frame);
+  ReturnFrame(frame);
+  DeallocatePage(page_id);
   return true;
 }
 
-bool BufferPoolManagerInstance::UnpinPgImp(page_id_t page_id, bool is_dirty) { 
-  std::scoped_lock lk{latch_};
-  auto iter = page_table_.find(page_id);
-  if(iter == page_table_.end()){
-    return false;
-  }
-  frame_id_t frame = iter->second;
-  Page *page = &pages_[frame];
-  if(page->GetPinCount() <= 0){ // 没被pin过
-    return false;
+bool BufferPoolManagerInstance::UnpinPgImp(page_id_t page_id, bool is_dirty) {
+  bool unpinned = false;
+  bool evictable = false;
+  frame_id_t frame = -1;
+  // 在分片锁下修改，保证置脏完成之前该frame不会被替换
+  page_table_.Find(page_id, [&](frame_id_t cur) {
+    frame = cur;
+    Page *page = &pages_[cur];
+    int pin_count = page->GetPinCount();
+    do {
+      if (pin_count <= 0) {  // 没被pin过
+        return;
+      }
+    } while (!page->pin_count_.compare_exchange_weak(pin_count, pin_count - 1));
+    if (is_dirty) {
+      page->is_dirty_ = true;
+    }
+    unpinned = true;
+    evictable = pin_count == 1;
+  });
+  if (evictable) {
+    replacer_->Unpin(frame);
   }
-  page->pin_count_ -= 1;
-  if(is_dirty) {
-    page->is_dirty_ = true;
+  return unpinned;
+}
+
+page_id_t BufferPoolManagerInstance::AllocatePage(bool *reused) {
+  // 先复用本实例释放的页面，文件不会因为反复分配释放而一直变大
+  page_id_t page_id = disk_manager_->AllocateFreePage(instance_index_);
+  if (reused != nullptr) {
+    *reused = page_id != INVALID_PAGE_ID;
   }
-  if(page->GetPinCount() <= 0){
-    replacer_->Unpin(frame);
+  if (page_id == INVALID_PAGE_ID) {
+    page_id = next_page_id_.fetch_add(num_instances_);
   }
-  return true;
+  ValidatePageId(page_id);
+  return page_id;
 }
 
-page_id_t BufferPoolManagerInstance::AllocatePage() {
-  const page_id_t next_page_id = next_page_id_;
-  next_page_id_ += num_instances_;
-  ValidatePageId(next_page_id);
-  return next_page_id;
+void BufferPoolManagerInstance::DeallocatePage(page_id_t page_id) {
+  // 只回收本实例分配过的页面，还没分配到的id以后会由计数器分配
+  if (page_id >= 0 && page_id < next_page_id_ && page_id % num_instances_ == instance_index_) {
+    disk_manager_->DeallocatePage(page_id);
+  }
 }
 
 void BufferPoolManagerInstance::ValidatePageId(const page_id_t page_id) const {
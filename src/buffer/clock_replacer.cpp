@@ -14,16 +14,75 @@
 
 namespace bustub {
 
-ClockReplacer::ClockReplacer(size_t num_pages) {}
+ClockReplacer::ClockReplacer(size_t num_pages)
+    : num_pages_(num_pages), frames_(std::make_unique<std::atomic<uint8_t>[]>(num_pages)) {
+  for (size_t i = 0; i < num_pages_; i++) {
+    frames_[i] = 0;
+  }
+}
 
 ClockReplacer::~ClockReplacer() = default;
 
-bool ClockReplacer::Victim(frame_id_t *frame_id) { return false; }
+bool ClockReplacer::Victim(frame_id_t *frame_id) {
+  std::scoped_lock lk{latch_};
+  if (size_ == 0) {
+    return false;
+  }
+  // Two full sweeps are enough: the first one clears every reference bit. Concurrent unpins can keep setting them
+  // again, so give up rather than spin forever if the clock never settles.
+  for (size_t step = 0; step < 2 * num_pages_ + 1; step++) {
+    size_t frame = hand_;
+    hand_ = (hand_ + 1) % num_pages_;
+    uint8_t state = frames_[frame].load();
+    while ((state & IN_CLOCK) != 0) {
+      uint8_t next = (state & REFERENCED) != 0 ? IN_CLOCK : 0;
+      if (frames_[frame].compare_exchange_weak(state, next)) {
+        break;
+      }
+    }
+    if (state == IN_CLOCK) {
+      size_--;
+      *frame_id = static_cast<frame_id_t>(frame);
+      return true;
+    }
+  }
+  return false;
+}
 
-void ClockReplacer::Pin(frame_id_t frame_id) {}
+void ClockReplacer::Pin(frame_id_t frame_id) {
+  if (frame_id < 0 || static_cast<size_t>(frame_id) >= num_pages_) {
+    return;
+  }
+  if ((frames_[frame_id].fetch_and(static_cast<uint8_t>(~(IN_CLOCK | REFERENCED))) & IN_CLOCK) != 0) {
+    size_--;
+  }
+}
 
-void ClockReplacer::Unpin(frame_id_t frame_id) {}
+void ClockReplacer::Unpin(frame_id_t frame_id) {
+  if (frame_id < 0 || static_cast<size_t>(frame_id) >= num_pages_) {
+    return;
+  }
+  // A frame outside the clock always has both bits clear. Unpinning a frame that is already in the clock leaves its
+  // reference bit alone, just like LRUReplacer ignores it.
+  uint8_t state = 0;
+  if (frames_[frame_id].compare_exchange_strong(state, IN_CLOCK | REFERENCED)) {
+    size_++;
+  }
+}
 
-size_t ClockReplacer::Size() { return 0; }
+void ClockReplacer::PeekVictims(size_t max_frames, std::vector<frame_id_t> *frames) {
+  std::scoped_lock lk{latch_};
+  // The first sweep of Victim takes the frames without a reference bit, the second one takes the rest.
+  for (uint8_t wanted : {IN_CLOCK, static_cast<uint8_t>(IN_CLOCK | REFERENCED)}) {
+    for (size_t step = 0; step < num_pages_ && frames->size() < max_frames; step++) {
+      size_t frame = (hand_ + step) % num_pages_;
+      if (frames_[frame].load() == wanted) {
+        frames->push_back(static_cast<frame_id_t>(frame));
+      }
+    }
+  }
+}
+
+size_t ClockReplacer::Size() { return size_; }
 
 }  // namespace bustub
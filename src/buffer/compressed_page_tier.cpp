@@ -0,0 +1,93 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// compressed_page_tier.cpp
+//
+// Identification: src/buffer/compressed_page_tier.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/compressed_page_tier.h"
+
+#include <cstring>
+#include <iterator>
+#include <utility>
+#include <vector>
+
+#include "common/util/page_codec.h"
+
+namespace bustub {
+
+CompressedPageTier::CompressedPageTier(size_t budget_bytes) : budget_bytes_(budget_bytes) {}
+
+bool CompressedPageTier::Put(page_id_t page_id, const char *page_data) {
+  // 压缩时不持有latch_；压不到MAX_RATIO以内的页面不值得占用内存
+  static thread_local std::vector<char> buffer(PageCodec::MaxCompressedSize());
+  auto limit = static_cast<size_t>(PAGE_SIZE * MAX_RATIO);
+  size_t size = PageCodec::Compress(page_data, buffer.data(), buffer.size());
+  if (size == 0 || size > limit || size > budget_bytes_) {
+    rejected_++;
+    Erase(page_id);
+    return false;
+  }
+  Entry entry{page_id, size, std::make_unique<char[]>(size)};
+  memcpy(entry.data_.get(), buffer.data(), size);
+
+  std::scoped_lock lk{latch_};
+  auto iter = index_.find(page_id);
+  if (iter != index_.end()) {
+    EraseLocked(iter->second);
+  }
+  entries_.push_front(std::move(entry));
+  index_[page_id] = entries_.begin();
+  bytes_used_ += size;
+  size_++;
+  puts_++;
+  // 超出预算时丢弃最早放入的页面
+  while (bytes_used_ > budget_bytes_) {
+    EraseLocked(std::prev(entries_.end()));
+    budget_evictions_++;
+  }
+  return true;
+}
+
+bool CompressedPageTier::Take(page_id_t page_id, char *page_data) {
+  Entry entry;
+  {
+    std::scoped_lock lk{latch_};
+    auto iter = index_.find(page_id);
+    if (iter == index_.end()) {
+      misses_++;
+      return false;
+    }
+    entry = std::move(*iter->second);
+    EraseLocked(iter->second);
+  }
+  // 解压时不持有latch_
+  if (!PageCodec::Decompress(entry.data_.get(), entry.size_, page_data)) {
+    misses_++;
+    return false;
+  }
+  hits_++;
+  return true;
+}
+
+void CompressedPageTier::Erase(page_id_t page_id) {
+  std::scoped_lock lk{latch_};
+  auto iter = index_.find(page_id);
+  if (iter != index_.end()) {
+    EraseLocked(iter->second);
+  }
+}
+
+void CompressedPageTier::EraseLocked(std::list<Entry>::iterator iter) {
+  bytes_used_ -= iter->size_;
+  size_--;
+  index_.erase(iter->page_id_);
+  entries_.erase(iter);
+}
+
+}  // namespace bustub
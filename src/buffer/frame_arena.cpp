@@ -0,0 +1,75 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// frame_arena.cpp
+//
+// Identification: src/buffer/frame_arena.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/frame_arena.h"
+
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstdint>
+
+#include "common/exception.h"
+#include "common/util/numa_util.h"
+
+namespace bustub {
+
+/** Round value up to a multiple of alignment, which must be a power of two. */
+static size_t AlignUp(size_t value, size_t alignment) { return (value + alignment - 1) & ~(alignment - 1); }
+
+FrameArena::FrameArena(size_t num_frames, bool huge_pages) {
+  static_assert(PAGE_SIZE % 4096 == 0, "frames must be aligned for O_DIRECT");
+  auto os_page_size = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+  size_t length = std::max<size_t>(num_frames, 1) * PAGE_SIZE;
+
+  if (huge_pages) {
+    granularity_ = HUGE_PAGE_SIZE;
+    length_ = AlignUp(length, HUGE_PAGE_SIZE);
+    // 不加MAP_NORESERVE：huge page不够时mmap直接失败，而不是在第一次访问时SIGBUS
+    mapping_ = mmap(nullptr, length_, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+    if (mapping_ != MAP_FAILED) {
+      huge_tlb_ = true;
+      mapping_length_ = length_;
+      base_ = static_cast<char *>(mapping_);
+      return;
+    }
+    // 系统没有预留huge page，退回到透明大页：多映射一个huge page，从中截取对齐的部分
+    mapping_length_ = length_ + HUGE_PAGE_SIZE;
+  } else {
+    granularity_ = std::max(os_page_size, static_cast<size_t>(PAGE_SIZE));
+    length_ = AlignUp(length, granularity_);
+    mapping_length_ = length_;
+  }
+
+  mapping_ = mmap(nullptr, mapping_length_, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+  if (mapping_ == MAP_FAILED) {
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "cannot reserve memory for the buffer pool frames");
+  }
+  base_ = reinterpret_cast<char *>(AlignUp(reinterpret_cast<uintptr_t>(mapping_), granularity_));
+  if (huge_pages) {
+    madvise(base_, length_, MADV_HUGEPAGE);
+  }
+}
+
+FrameArena::~FrameArena() { munmap(mapping_, mapping_length_); }
+
+void FrameArena::BindToNode(int node) { NumaUtil::BindMemory(base_, length_, node); }
+
+void FrameArena::Release(size_t begin, size_t end) {
+  size_t from = AlignUp(begin * PAGE_SIZE, granularity_);
+  size_t to = std::min(end * PAGE_SIZE, length_) / granularity_ * granularity_;
+  if (from < to) {
+    madvise(base_ + from, to - from, MADV_DONTNEED);
+  }
+}
+
+}  // namespace bustub
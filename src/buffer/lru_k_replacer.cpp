@@ -0,0 +1,167 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// lru_k_replacer.cpp
+//
+// Identification: src/buffer/lru_k_replacer.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/lru_k_replacer.h"
+
+#include <algorithm>
+#include <iterator>
+
+#include "common/macros.h"
+
+namespace bustub {
+
+LRUKReplacer::LRUKReplacer(size_t num_pages, size_t k, std::chrono::nanoseconds correlated_period)
+    : num_pages_(num_pages), k_(k), correlated_period_(correlated_period), frames_(num_pages), history_(num_pages * k) {
+  BUSTUB_ASSERT(k > 0, "LRU-K needs at least one reference per frame");
+}
+
+LRUKReplacer::~LRUKReplacer() = default;
+
+bool LRUKReplacer::Victim(frame_id_t *frame_id) {
+  std::scoped_lock lk{latch_};
+  if (evictable_.empty()) {
+    return false;
+  }
+  auto iter = evictable_.begin();
+  *frame_id = std::get<2>(*iter);
+  evictable_.erase(iter);
+  // The frame will hold a different page, so its history starts over; the evicted page keeps its own for a while.
+  RetainHistory(*frame_id);
+  frames_[*frame_id] = FrameHistory();
+  return true;
+}
+
+void LRUKReplacer::Pin(frame_id_t frame_id) {
+  if (frame_id < 0 || static_cast<size_t>(frame_id) >= num_pages_) {
+    return;
+  }
+  std::scoped_lock lk{latch_};
+  RecordReference(frame_id);
+  FrameHistory &frame = frames_[frame_id];
+  if (frame.evictable_) {
+    evictable_.erase(frame.key_);
+    frame.evictable_ = false;
+  }
+}
+
+void LRUKReplacer::Unpin(frame_id_t frame_id) {
+  if (frame_id < 0 || static_cast<size_t>(frame_id) >= num_pages_) {
+    return;
+  }
+  std::scoped_lock lk{latch_};
+  FrameHistory &frame = frames_[frame_id];
+  if (frame.evictable_) {
+    return;
+  }
+  // A frame that was never pinned still needs a position in the eviction order.
+  if (frame.num_refs_ == 0) {
+    RecordReference(frame_id);
+  }
+  frame.key_ = MakeKey(frame_id);
+  frame.evictable_ = true;
+  evictable_.insert(frame.key_);
+}
+
+void LRUKReplacer::SetPage(frame_id_t frame_id, page_id_t page_id, bool new_page) {
+  if (frame_id < 0 || static_cast<size_t>(frame_id) >= num_pages_) {
+    return;
+  }
+  std::scoped_lock lk{latch_};
+  FrameHistory &frame = frames_[frame_id];
+  auto iter = retained_.find(page_id);
+  if (iter != retained_.end()) {
+    // A new page on a reused id has nothing to do with the deleted page that had it.
+    if (!new_page && !frame.evictable_) {
+      frame = iter->second.frame_;
+      std::copy(iter->second.refs_.begin(), iter->second.refs_.end(), history_.begin() + frame_id * k_);
+    }
+    retained_order_.erase(iter->second.order_);
+    retained_.erase(iter);
+  }
+  frame.page_id_ = page_id;
+}
+
+void LRUKReplacer::Remove(frame_id_t frame_id) {
+  if (frame_id < 0 || static_cast<size_t>(frame_id) >= num_pages_) {
+    return;
+  }
+  std::scoped_lock lk{latch_};
+  FrameHistory &frame = frames_[frame_id];
+  if (frame.evictable_) {
+    evictable_.erase(frame.key_);
+  }
+  frame = FrameHistory();
+}
+
+void LRUKReplacer::PeekVictims(size_t max_frames, std::vector<frame_id_t> *frames) {
+  std::scoped_lock lk{latch_};
+  for (auto iter = evictable_.begin(); iter != evictable_.end() && frames->size() < max_frames; ++iter) {
+    frames->push_back(std::get<2>(*iter));
+  }
+}
+
+size_t LRUKReplacer::Size() {
+  std::scoped_lock lk{latch_};
+  return evictable_.size();
+}
+
+void LRUKReplacer::RecordReference(frame_id_t frame_id) {
+  FrameHistory &frame = frames_[frame_id];
+  auto now = Now();
+  // Measured from the last counted reference rather than the last one, so that a frame referenced without pause
+  // still ages into a new reference every period.
+  if (frame.num_refs_ > 0 && correlated_period_.count() > 0 && now - frame.last_counted_ <= correlated_period_) {
+    return;
+  }
+  history_[frame_id * k_ + frame.next_slot_] = ++current_timestamp_;
+  frame.next_slot_ = (frame.next_slot_ + 1) % k_;
+  frame.num_refs_ = std::min(frame.num_refs_ + 1, k_);
+  frame.last_counted_ = now;
+}
+
+void LRUKReplacer::RetainHistory(frame_id_t frame_id) {
+  const FrameHistory &frame = frames_[frame_id];
+  if (frame.page_id_ == INVALID_PAGE_ID || frame.num_refs_ == 0 || num_pages_ == 0) {
+    return;
+  }
+  auto iter = retained_.find(frame.page_id_);
+  if (iter != retained_.end()) {
+    retained_order_.erase(iter->second.order_);
+    retained_.erase(iter);
+  }
+  if (retained_.size() >= num_pages_) {
+    retained_.erase(retained_order_.front());
+    retained_order_.pop_front();
+  }
+  auto refs = history_.begin() + frame_id * k_;
+  retained_order_.push_back(frame.page_id_);
+  FrameHistory kept = frame;
+  kept.evictable_ = false;
+  retained_.emplace(frame.page_id_, RetainedHistory{kept, std::vector<uint64_t>(refs, refs + k_),
+                                                    std::prev(retained_order_.end())});
+}
+
+LRUKReplacer::EvictionKey LRUKReplacer::MakeKey(frame_id_t frame_id) const {
+  const FrameHistory &frame = frames_[frame_id];
+  if (frame.num_refs_ < k_) {
+    // Infinite backward K-distance: fall back to plain LRU on the oldest reference we know of.
+    return {0, RecentReference(frame_id, frame.num_refs_ - 1), frame_id};
+  }
+  return {1, RecentReference(frame_id, k_ - 1), frame_id};
+}
+
+uint64_t LRUKReplacer::RecentReference(frame_id_t frame_id, size_t i) const {
+  size_t slot = (frames_[frame_id].next_slot_ + k_ - 1 - i) % k_;
+  return history_[frame_id * k_ + slot];
+}
+
+}  // namespace bustub
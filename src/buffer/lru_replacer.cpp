@@ -12,53 +12,88 @@
 
 #include "buffer/lru_replacer.h"
 
+#include <algorithm>
+#include <functional>
+
 namespace bustub {
 
-LRUReplacer::LRUReplacer(size_t num_pages) {
-    size = num_pages;
+LRUReplacer::LRUReplacer(size_t num_pages)
+    : num_pages_(num_pages), stamps_(std::make_unique<std::atomic<uint64_t>[]>(num_pages)) {
+  for (size_t i = 0; i < num_pages_; i++) {
+    stamps_[i] = 0;
+  }
 }
 
 LRUReplacer::~LRUReplacer() = default;
 
-bool LRUReplacer::Victim(frame_id_t *frame_id) { 
-    //c++17中关于scoped_lock的使用
-    std::scoped_lock lk{mu};
-    if(lru_cache.empty()){
+bool LRUReplacer::Victim(frame_id_t *frame_id) {
+  std::scoped_lock lk{latch_};
+  bool collected = false;
+  while (true) {
+    if (candidates_.empty()) {
+      // 重新收集过一次还是没有，说明没有可以替换的frame
+      if (collected || size_ == 0) {
         return false;
+      }
+      CollectCandidates(&candidates_);
+      collected = true;
+      continue;
+    }
+    auto [stamp, frame] = candidates_.back();
+    candidates_.pop_back();
+    // 收集之后又被pin或者重新unpin过的frame跳过，它的新位置在下一次收集时得到
+    if (stamps_[frame].compare_exchange_strong(stamp, 0)) {
+      size_--;
+      *frame_id = frame;
+      return true;
     }
-    *frame_id = lru_cache.back();
-    lru_hash.erase(*frame_id);
-    lru_cache.pop_back();
-    return true;
+  }
 }
-// 被pin中的page不应成为victim，从replacer中移除
+
 void LRUReplacer::Pin(frame_id_t frame_id) {
-    std::scoped_lock lk{mu};
-    auto iter = lru_hash.find(frame_id);
-    if(iter == lru_hash.end()){
-        // 没找到
-        return;
-    }
-    lru_cache.erase(iter->second);
-    lru_hash.erase(iter);
+  if (frame_id < 0 || static_cast<size_t>(frame_id) >= num_pages_) {
+    return;
+  }
+  if (stamps_[frame_id].exchange(0) != 0) {
+    size_--;
+  }
 }
 
 void LRUReplacer::Unpin(frame_id_t frame_id) {
-    std::scoped_lock lk{mu};
-    if(lru_hash.find(frame_id) != lru_hash.end()){
-        return;
-    }
-    if(lru_cache.size() >= size){
-        return ;
-    }
-    //根据lru，添加到链表头
-    lru_cache.push_front(frame_id);
-    lru_hash[frame_id] = lru_cache.begin();
+  if (frame_id < 0 || static_cast<size_t>(frame_id) >= num_pages_) {
+    return;
+  }
+  // 已经在replacer中的frame保持原来的位置，也不用去取共享的时钟
+  if (stamps_[frame_id].load(std::memory_order_relaxed) != 0) {
+    return;
+  }
+  uint64_t stamp = 0;
+  if (stamps_[frame_id].compare_exchange_strong(stamp, clock_.fetch_add(1) + 1)) {
+    size_++;
+  }
+}
+
+void LRUReplacer::PeekVictims(size_t max_frames, std::vector<frame_id_t> *frames) {
+  std::scoped_lock lk{latch_};
+  std::vector<std::pair<uint64_t, frame_id_t>> candidates;
+  CollectCandidates(&candidates);
+  for (auto iter = candidates.rbegin(); iter != candidates.rend() && frames->size() < max_frames; ++iter) {
+    frames->push_back(iter->second);
+  }
 }
 
-size_t LRUReplacer::Size() { 
-    std::scoped_lock lk{mu};
-    return lru_cache.size();
+size_t LRUReplacer::Size() { return size_; }
+
+void LRUReplacer::CollectCandidates(std::vector<std::pair<uint64_t, frame_id_t>> *candidates) {
+  candidates->clear();
+  for (size_t i = 0; i < num_pages_; i++) {
+    uint64_t stamp = stamps_[i].load();
+    if (stamp != 0) {
+      candidates->emplace_back(stamp, static_cast<frame_id_t>(i));
+    }
+  }
+  // 按unpin时间从新到旧排序，最老的在末尾
+  std::sort(candidates->begin(), candidates->end(), std::greater<>());
 }
 
 }  // namespace bustub
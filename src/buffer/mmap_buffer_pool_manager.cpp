@@ -0,0 +1,100 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// mmap_buffer_pool_manager.cpp
+//
+// Identification: src/buffer/mmap_buffer_pool_manager.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/mmap_buffer_pool_manager.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "common/exception.h"
+
+namespace bustub {
+
+MmapBufferPoolManager::MmapBufferPoolManager(const std::string &db_file) {
+  int fd = open(db_file.c_str(), O_RDONLY);
+  if (fd < 0) {
+    throw Exception("can't open db file");
+  }
+  struct stat stat_buf;
+  if (fstat(fd, &stat_buf) != 0) {
+    close(fd);
+    throw Exception("can't stat db file");
+  }
+  num_pages_ = static_cast<size_t>(stat_buf.st_size) / PAGE_SIZE;
+  // 空文件不能映射
+  if (num_pages_ > 0) {
+    void *mapping = mmap(nullptr, num_pages_ * PAGE_SIZE, PROT_READ, MAP_SHARED, fd, 0);
+    if (mapping == MAP_FAILED) {
+      close(fd);
+      throw Exception(ExceptionType::OUT_OF_MEMORY, "can't map db file");
+    }
+    base_ = static_cast<char *>(mapping);
+  }
+  // 映射建立之后就不再需要文件描述符
+  close(fd);
+
+  pages_ = std::make_unique<Page[]>(num_pages_);
+  for (size_t i = 0; i < num_pages_; ++i) {
+    pages_[i].data_ = base_ + i * PAGE_SIZE;
+    pages_[i].page_id_ = static_cast<page_id_t>(i);
+  }
+}
+
+MmapBufferPoolManager::~MmapBufferPoolManager() {
+  if (base_ != nullptr) {
+    munmap(base_, num_pages_ * PAGE_SIZE);
+  }
+}
+
+Page *MmapBufferPoolManager::FetchPgImp(page_id_t page_id) {
+  if (!IsMapped(page_id)) {
+    return nullptr;
+  }
+  // 不拷贝、不加缓冲池的锁：缺页时由操作系统读入
+  Page *page = &pages_[page_id];
+  page->pin_count_.fetch_add(1);
+  return page;
+}
+
+void MmapBufferPoolManager::PrefetchPgImp(page_id_t page_id) {
+  if (IsMapped(page_id)) {
+    madvise(pages_[page_id].data_, PAGE_SIZE, MADV_WILLNEED);
+  }
+}
+
+bool MmapBufferPoolManager::UnpinPgImp(page_id_t page_id, bool is_dirty) {
+  BUSTUB_ASSERT(!is_dirty, "pages of a read-only mapping cannot be dirty");
+  if (!IsMapped(page_id)) {
+    return false;
+  }
+  Page *page = &pages_[page_id];
+  int pin_count = page->GetPinCount();
+  do {
+    if (pin_count <= 0) {
+      return false;
+    }
+  } while (!page->pin_count_.compare_exchange_weak(pin_count, pin_count - 1));
+  return true;
+}
+
+bool MmapBufferPoolManager::FlushPgImp(page_id_t page_id) { return IsMapped(page_id); }
+
+Page *MmapBufferPoolManager::NewPgImp(page_id_t *page_id) {
+  *page_id = INVALID_PAGE_ID;
+  return nullptr;
+}
+
+bool MmapBufferPoolManager::DeletePgImp(page_id_t page_id) { return !IsMapped(page_id); }
+
+}  // namespace bustub
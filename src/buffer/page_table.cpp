@@ -0,0 +1,31 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// page_table.cpp
+//
+// Identification: src/buffer/page_table.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/page_table.h"
+
+namespace bustub {
+
+PageTable::PageTable(size_t num_shards) : num_shards_(1), shard_bits_(0) {
+  while (num_shards_ < num_shards) {
+    num_shards_ <<= 1;
+    shard_bits_++;
+  }
+  shards_ = std::make_unique<Shard[]>(num_shards_);
+}
+
+void PageTable::Insert(page_id_t page_id, frame_id_t frame_id) {
+  Shard &shard = GetShard(page_id);
+  std::scoped_lock lk{shard.latch_};
+  shard.map_[page_id] = frame_id;
+}
+
+}  // namespace bustub
@@ -12,16 +12,29 @@
 
 #include "buffer/parallel_buffer_pool_manager.h"
 
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+#include "common/util/numa_util.h"
+
 namespace bustub {
 
 ParallelBufferPoolManager::ParallelBufferPoolManager(size_t num_instances, size_t pool_size, DiskManager *disk_manager,
-                                                     LogManager *log_manager) {
+                                                     LogManager *log_manager, const BufferPoolOptions &options) {
   // Allocate and create individual BufferPoolManagerInstances
   num_ins = num_instances;
   size_pool = pool_size;
   next_ins = 0;
+  this->disk_manager = disk_manager;
+  thread_affinity = options.new_page_thread_affinity_;
+  numa_nodes = options.numa_aware_ ? std::min(static_cast<size_t>(NumaUtil::NumNodes()), num_ins) : 1;
   for(size_t i=0; i<num_ins; i++){
-    managers_.push_back(new BufferPoolManagerInstance(size_pool,num_ins,i,disk_manager,log_manager));
+    BufferPoolOptions instance_options = options;
+    if (options.numa_aware_) {
+      instance_options.numa_node_ = static_cast<int>(i % numa_nodes);
+    }
+    managers_.push_back(new BufferPoolManagerInstance(size_pool,num_ins,i,disk_manager,log_manager,instance_options));
   }
 
 }
@@ -35,7 +48,43 @@ ParallelBufferPoolManager::~ParallelBufferPoolManager(){
 
 size_t ParallelBufferPoolManager::GetPoolSize() {
   // Get size of all BufferPoolManagerInstances
-  return num_ins * size_pool;
+  size_t pool_size = 0;
+  for (auto *manager : managers_) {
+    pool_size += manager->GetPoolSize();
+  }
+  return pool_size;
+}
+
+bool ParallelBufferPoolManager::Resize(size_t pool_size, std::chrono::milliseconds timeout) {
+  // 所有实例的上限相同，超出范围时一个实例都不改
+  if (pool_size == 0 || pool_size > managers_[0]->GetMaxPoolSize()) {
+    return false;
+  }
+  std::scoped_lock lk{resize_latch};
+  // 所有实例共用一个截止时间，最多阻塞timeout
+  auto deadline = std::chrono::steady_clock::now() + timeout;
+  for (size_t i = 0; i < num_ins; i++) {
+    auto remaining = std::max(std::chrono::duration_cast<std::chrono::milliseconds>(
+                                  deadline - std::chrono::steady_clock::now()),
+                              std::chrono::milliseconds(0));
+    if (!managers_[i]->Resize(pool_size, remaining)) {
+      // 只有缩容会失败，已经缩小的实例扩容回去，扩容总会成功
+      for (size_t j = 0; j < i; j++) {
+        managers_[j]->Resize(size_pool);
+      }
+      return false;
+    }
+  }
+  size_pool = pool_size;
+  return true;
+}
+
+BufferPoolStats ParallelBufferPoolManager::GetStats() {
+  BufferPoolStats stats;
+  for (auto *manager : managers_) {
+    stats += manager->GetStats();
+  }
+  return stats;
 }
 
 BufferPoolManager *ParallelBufferPoolManager::GetBufferPoolManager(page_id_t page_id) {
@@ -48,6 +97,14 @@ Page *ParallelBufferPoolManager::FetchPgImp(page_id_t page_id) {
   return GetBufferPoolManager(page_id)->FetchPage(page_id);
 }
 
+Page *ParallelBufferPoolManager::FetchPgStrategyImp(page_id_t page_id, BufferAccessStrategy *strategy) {
+  return GetBufferPoolManager(page_id)->FetchPageWithStrategy(page_id, strategy);
+}
+
+void ParallelBufferPoolManager::PrefetchPgImp(page_id_t page_id) {
+  GetBufferPoolManager(page_id)->PrefetchPage(page_id);
+}
+
 bool ParallelBufferPoolManager::UnpinPgImp(page_id_t page_id, bool is_dirty) {
   // Unpin page_id from responsible BufferPoolManagerInstance
   BufferPoolManager *manager = GetBufferPoolManager(page_id);
@@ -59,25 +116,46 @@ bool ParallelBufferPoolManager::FlushPgImp(page_id_t page_id) {
   return GetBufferPoolManager(page_id)->FlushPage(page_id);
 }
 
-Page *ParallelBufferPoolManager::NewPgImp(page_id_t *page_id) {
+Page *ParallelBufferPoolManager::NewPgImp(page_id_t *page_id) { return NewPgStrategyImp(page_id, nullptr); }
+
+Page *ParallelBufferPoolManager::NewPgStrategyImp(page_id_t *page_id, BufferAccessStrategy *strategy) {
   // create new page. We will request page allocation in a round robin manner from the underlying
   // BufferPoolManagerInstances
   // 1.   From a starting index of the BPMIs, call NewPageImpl until either 1) success and return 2) looped around to
   // starting index and return nullptr
   // 2.   Bump the starting index (mod number of instances) to start search at a different BPMI each time this function
   // is called
-  // std::scoped_lock lk{latch};
-  for(size_t i=0; i<num_ins; i++){
-    BufferPoolManager *manager = managers_[i];
-    Page *page = manager->NewPage(page_id);
-    next_ins = (next_ins+1) % num_ins;
-    if(page != nullptr){
+  // 每个线程有自己的起点，或者所有线程通过原子游标轮流选起点，避免所有分配都从0号实例开始
+  size_t cursor = thread_affinity ? ThreadSlot() : next_ins.fetch_add(1);
+  // 先在当前线程所在NUMA节点的实例里找（节点node的实例是node, node+numa_nodes, ...）
+  size_t node = numa_nodes > 1 ? NumaUtil::CurrentNode() % numa_nodes : 0;
+  size_t num_local = (num_ins - node + numa_nodes - 1) / numa_nodes;
+  for (size_t i = 0; i < num_local; i++) {
+    Page *page = managers_[node + (cursor + i) % num_local * numa_nodes]->NewPageWithStrategy(page_id, strategy);
+    if (page != nullptr) {
+      return page;
+    }
+  }
+  // 本节点的实例都满了，再去其他节点找
+  for (size_t i = 0; i < num_ins && numa_nodes > 1; i++) {
+    size_t index = (cursor + i) % num_ins;
+    if (index % numa_nodes == node) {
+      continue;
+    }
+    Page *page = managers_[index]->NewPageWithStrategy(page_id, strategy);
+    if (page != nullptr) {
       return page;
     }
   }
   return nullptr;
 }
 
+size_t ParallelBufferPoolManager::ThreadSlot() {
+  static std::atomic<size_t> next_slot{0};
+  thread_local size_t slot = next_slot.fetch_add(1);
+  return slot;
+}
+
 bool ParallelBufferPoolManager::DeletePgImp(page_id_t page_id) {
   // Delete page_id from responsible BufferPoolManagerInstance
   return GetBufferPoolManager(page_id)->DeletePage(page_id);
@@ -85,7 +163,12 @@ bool ParallelBufferPoolManager::DeletePgImp(page_id_t page_id) {
 
 void ParallelBufferPoolManager::FlushAllPgsImp() {
   // flush all pages from all BufferPoolManagerInstances
-  FlushAllPages();
+  // 各个实例的page id交错分布，合在一起排序才能把相邻的页面合并写
+  std::vector<std::pair<page_id_t, BufferPoolManagerInstance *>> dirty_pages;
+  for (auto *manager : managers_) {
+    manager->CollectDirtyPages(&dirty_pages);
+  }
+  BufferPoolManagerInstance::WriteDirtyPages(disk_manager, &dirty_pages);
 }
 
 }  // namespace bustub
@@ -0,0 +1,94 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// rwlatch.cpp
+//
+// Identification: src/common/rwlatch.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "common/rwlatch.h"
+
+#ifdef __linux__
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#include <climits>
+#include <thread>  // NOLINT
+
+namespace bustub {
+
+namespace {
+
+/** Tell the CPU we are in a spin loop. */
+inline void CpuRelax() {
+#if defined(__x86_64__) || defined(__i386__)
+  __builtin_ia32_pause();
+#elif defined(__aarch64__)
+  asm volatile("yield" ::: "memory");
+#endif
+}
+
+}  // namespace
+
+void ReaderWriterLatch::WLockSlow() {
+  state_.fetch_add(WAITING_WRITER, std::memory_order_relaxed);
+  int spins = 0;
+  while (true) {
+    uint32_t state = state_.load(std::memory_order_relaxed);
+    if ((state & (WRITER | READERS_MASK)) == 0) {
+      // Keep PARKED as it is: readers parked behind us must still be woken when we unlock.
+      if (state_.compare_exchange_weak(state, (state - WAITING_WRITER) | WRITER, std::memory_order_acquire,
+                                       std::memory_order_relaxed)) {
+        return;
+      }
+      continue;
+    }
+    Wait(state, &spins);
+  }
+}
+
+void ReaderWriterLatch::RLockSlow() {
+  int spins = 0;
+  while (true) {
+    uint32_t state = state_.load(std::memory_order_relaxed);
+    if ((state & (WRITER | WAITING_WRITERS_MASK)) == 0 && (state & READERS_MASK) != MAX_READERS) {
+      if (state_.compare_exchange_weak(state, state + 1, std::memory_order_acquire, std::memory_order_relaxed)) {
+        return;
+      }
+      continue;
+    }
+    Wait(state, &spins);
+  }
+}
+
+void ReaderWriterLatch::Wait(uint32_t state, int *spins) {
+  if (++*spins <= SPIN_LIMIT) {
+    CpuRelax();
+    return;
+  }
+  // Announce that we park before doing so, so that the unlock that changes state_ next knows to wake us. If state_
+  // changed in the meantime the CAS fails and the caller re-checks it instead.
+  if ((state & PARKED) == 0 &&
+      !state_.compare_exchange_strong(state, state | PARKED, std::memory_order_relaxed, std::memory_order_relaxed)) {
+    return;
+  }
+#ifdef __linux__
+  syscall(SYS_futex, reinterpret_cast<uint32_t *>(&state_), FUTEX_WAIT_PRIVATE, state | PARKED, nullptr, nullptr, 0);
+#else
+  std::this_thread::yield();
+#endif
+}
+
+void ReaderWriterLatch::WakeAll() {
+#ifdef __linux__
+  syscall(SYS_futex, reinterpret_cast<uint32_t *>(&state_), FUTEX_WAKE_PRIVATE, INT_MAX, nullptr, nullptr, 0);
+#endif
+}
+
+}  // namespace bustub
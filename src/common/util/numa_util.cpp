@@ -0,0 +1,63 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// numa_util.cpp
+//
+// Identification: src/common/util/numa_util.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "common/util/numa_util.h"
+
+#ifdef BUSTUB_HAVE_NUMA
+#include <numa.h>
+#include <sched.h>
+#endif
+
+#include <algorithm>
+
+namespace bustub {
+
+#ifdef BUSTUB_HAVE_NUMA
+
+bool NumaUtil::IsAvailable() {
+  static const bool available = numa_available() >= 0;
+  return available;
+}
+
+int NumaUtil::NumNodes() { return IsAvailable() ? std::max(numa_max_node() + 1, 1) : 1; }
+
+int NumaUtil::CurrentNode() {
+  if (!IsAvailable()) {
+    return 0;
+  }
+  int cpu = sched_getcpu();
+  return cpu < 0 ? 0 : std::max(numa_node_of_cpu(cpu), 0);
+}
+
+void NumaUtil::BindMemory(void *addr, size_t length, int node) {
+  if (IsAvailable() && node >= 0 && node < NumNodes()) {
+    numa_tonode_memory(addr, length, node);
+  }
+}
+
+bool NumaUtil::RunOnNode(int node) { return IsAvailable() && numa_run_on_node(node) == 0; }
+
+#else
+
+bool NumaUtil::IsAvailable() { return false; }
+
+int NumaUtil::NumNodes() { return 1; }
+
+int NumaUtil::CurrentNode() { return 0; }
+
+void NumaUtil::BindMemory(void *addr, size_t length, int node) {}
+
+bool NumaUtil::RunOnNode(int node) { return false; }
+
+#endif
+
+}  // namespace bustub
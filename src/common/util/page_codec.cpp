@@ -0,0 +1,165 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// page_codec.cpp
+//
+// Identification: src/common/util/page_codec.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "common/util/page_codec.h"
+
+#ifdef BUSTUB_HAVE_LZ4
+#include <lz4.h>
+#endif
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+
+#include "common/config.h"
+
+namespace bustub {
+
+#ifdef BUSTUB_HAVE_LZ4
+
+const char *PageCodec::Name() { return "lz4"; }
+
+size_t PageCodec::MaxCompressedSize() { return LZ4_compressBound(PAGE_SIZE); }
+
+size_t PageCodec::Compress(const char *page, char *out, size_t capacity) {
+  return LZ4_compress_default(page, out, PAGE_SIZE, static_cast<int>(capacity));
+}
+
+bool PageCodec::Decompress(const char *in, size_t size, char *page) {
+  return LZ4_decompress_safe(in, page, static_cast<int>(size), PAGE_SIZE) == PAGE_SIZE;
+}
+
+#else
+
+// 内置编码：每个token字节后面跟着字面量或者一个回溯匹配
+//   0xxxxxxx：后面是x+1个字面量字节
+//   1xxxxxxx：复制x+MIN_MATCH个字节，来源在2字节（小端）偏移之前，允许和输出重叠
+namespace {
+
+constexpr size_t MIN_MATCH = 4;
+constexpr size_t MAX_MATCH = 0x7f + MIN_MATCH;
+constexpr size_t MAX_LITERALS = 0x80;
+constexpr size_t HASH_BITS = 12;
+
+inline uint32_t Load32(const char *p) {
+  uint32_t value;
+  memcpy(&value, p, sizeof(value));
+  return value;
+}
+
+inline size_t Hash(uint32_t value) { return (value * 2654435761U) >> (32 - HASH_BITS); }
+
+/** Append literals [begin, end) to out. @return false if they do not fit */
+bool EmitLiterals(const char *begin, const char *end, char *out, size_t capacity, size_t *out_size) {
+  while (begin < end) {
+    size_t count = std::min<size_t>(end - begin, MAX_LITERALS);
+    if (*out_size + 1 + count > capacity) {
+      return false;
+    }
+    out[(*out_size)++] = static_cast<char>(count - 1);
+    memcpy(out + *out_size, begin, count);
+    *out_size += count;
+    begin += count;
+  }
+  return true;
+}
+
+}  // namespace
+
+const char *PageCodec::Name() { return "builtin"; }
+
+size_t PageCodec::MaxCompressedSize() { return PAGE_SIZE + (PAGE_SIZE + MAX_LITERALS - 1) / MAX_LITERALS; }
+
+size_t PageCodec::Compress(const char *page, char *out, size_t capacity) {
+  // 记录位置加一，0表示空；页面不超过64KB，用uint16_t让表小一些
+  static_assert(PAGE_SIZE < (1 << 16), "match offsets are 16 bits");
+  uint16_t table[1 << HASH_BITS] = {0};
+  size_t out_size = 0;
+  size_t literal_start = 0;
+  size_t pos = 0;
+  while (pos + MIN_MATCH <= PAGE_SIZE) {
+    uint32_t word = Load32(page + pos);
+    size_t hash = Hash(word);
+    int candidate = table[hash] - 1;
+    table[hash] = static_cast<uint16_t>(pos + 1);
+    // 连续相同的字节（空闲空间里的0）编码成偏移为1的匹配，解压时就是一次memset
+    if (pos > 0 && Load32(page + pos - 1) == word) {
+      candidate = static_cast<int>(pos) - 1;
+    }
+    if (candidate < 0 || Load32(page + candidate) != word) {
+      pos++;
+      continue;
+    }
+    size_t length = MIN_MATCH;
+    while (pos + length < PAGE_SIZE && length < MAX_MATCH && page[candidate + length] == page[pos + length]) {
+      length++;
+    }
+    if (!EmitLiterals(page + literal_start, page + pos, out, capacity, &out_size) || out_size + 3 > capacity) {
+      return 0;
+    }
+    auto offset = static_cast<uint16_t>(pos - candidate);
+    out[out_size++] = static_cast<char>(0x80 | (length - MIN_MATCH));
+    out[out_size++] = static_cast<char>(offset & 0xff);
+    out[out_size++] = static_cast<char>(offset >> 8);
+    pos += length;
+    literal_start = pos;
+  }
+  if (!EmitLiterals(page + literal_start, page + PAGE_SIZE, out, capacity, &out_size)) {
+    return 0;
+  }
+  return out_size;
+}
+
+bool PageCodec::Decompress(const char *in, size_t size, char *page) {
+  size_t in_pos = 0;
+  size_t out_pos = 0;
+  while (in_pos < size) {
+    auto token = static_cast<uint8_t>(in[in_pos++]);
+    if ((token & 0x80) == 0) {
+      size_t count = token + 1;
+      if (in_pos + count > size || out_pos + count > PAGE_SIZE) {
+        return false;
+      }
+      memcpy(page + out_pos, in + in_pos, count);
+      in_pos += count;
+      out_pos += count;
+      continue;
+    }
+    if (in_pos + 2 > size) {
+      return false;
+    }
+    size_t length = (token & 0x7f) + MIN_MATCH;
+    size_t offset = static_cast<uint8_t>(in[in_pos]) | static_cast<size_t>(static_cast<uint8_t>(in[in_pos + 1])) << 8;
+    in_pos += 2;
+    if (offset == 0 || offset > out_pos || out_pos + length > PAGE_SIZE) {
+      return false;
+    }
+    // 源和目标可能重叠：偏移为1是重复单个字节。来源往往是刚写出的几个字节，短匹配逐字节复制，
+    // 否则宽读取跨越多次刚完成的写入，无法从store buffer转发
+    char *dst = page + out_pos;
+    if (offset == 1) {
+      memset(dst, dst[-1], length);
+    } else if (offset >= length && length >= 32) {
+      memcpy(dst, dst - offset, length);
+    } else {
+      for (size_t i = 0; i < length; i++) {
+        dst[i] = dst[i - offset];
+      }
+    }
+    out_pos += length;
+  }
+  return out_pos == PAGE_SIZE;
+}
+
+#endif
+
+}  // namespace bustub
@@ -14,10 +14,35 @@
 
 namespace bustub {
 
-SeqScanExecutor::SeqScanExecutor(ExecutorContext *exec_ctx, const SeqScanPlanNode *plan) : AbstractExecutor(exec_ctx) {}
+SeqScanExecutor::SeqScanExecutor(ExecutorContext *exec_ctx, const SeqScanPlanNode *plan)
+    : AbstractExecutor(exec_ctx),
+      plan_(plan),
+      table_info_(exec_ctx->GetCatalog()->GetTable(plan->GetTableOid())),
+      strategy_(std::make_unique<BufferAccessStrategy>(AccessStrategyType::BULK_READ)) {}
 
-void SeqScanExecutor::Init() {}
+void SeqScanExecutor::Init() {
+  iter_.emplace(table_info_->table_->Begin(exec_ctx_->GetTransaction(), strategy_.get()));
+}
 
-bool SeqScanExecutor::Next(Tuple *tuple, RID *rid) { return false; }
+bool SeqScanExecutor::Next(Tuple *tuple, RID *rid) {
+  const Schema *table_schema = &table_info_->schema_;
+  const Schema *output_schema = GetOutputSchema();
+  const AbstractExpression *predicate = plan_->GetPredicate();
+  for (; *iter_ != table_info_->table_->End(); ++*iter_) {
+    if (predicate != nullptr && !predicate->Evaluate(&**iter_, table_schema).GetAs<bool>()) {
+      continue;
+    }
+    std::vector<Value> values;
+    values.reserve(output_schema->GetColumnCount());
+    for (const auto &column : output_schema->GetColumns()) {
+      values.push_back(column.GetExpr()->Evaluate(&**iter_, table_schema));
+    }
+    *rid = (*iter_)->GetRid();
+    *tuple = Tuple(values, output_schema);
+    ++*iter_;
+    return true;
+  }
+  return false;
+}
 
 }  // namespace bustub
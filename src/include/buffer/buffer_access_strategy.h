@@ -0,0 +1,98 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// buffer_access_strategy.h
+//
+// Identification: src/include/buffer/buffer_access_strategy.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <vector>
+
+#include "common/config.h"
+#include "common/macros.h"
+
+namespace bustub {
+
+/** The kinds of bulk access that get their own ring of frames. */
+enum class AccessStrategyType { BULK_READ };
+
+/**
+ * BufferAccessStrategy gives a bulk operation, such as a sequential scan, a small private ring of frames.
+ *
+ * The first pages the operation reads take frames from the shared pool as usual. Once the ring is full, a miss
+ * recycles the frame that the operation loaded ring-size pages ago instead of asking the replacer for a victim, so
+ * a large scan keeps at most ring-size frames and never evicts the working set of other queries. A ring frame is only
+ * recycled if nobody else has pinned it and it still holds the page the operation put there; otherwise the miss falls
+ * back to the shared pool and the new frame takes the slot.
+ *
+ * A strategy belongs to a single operation and is not thread safe. It must outlive every page fetched through it.
+ */
+class BufferAccessStrategy {
+  friend class BufferPoolManagerInstance;
+
+ public:
+  /**
+   * Creates a new BufferAccessStrategy with the default ring size of its type.
+   * @param type the kind of bulk access
+   */
+  explicit BufferAccessStrategy(AccessStrategyType type);
+
+  /**
+   * Creates a new BufferAccessStrategy.
+   * @param type the kind of bulk access
+   * @param ring_size number of frames the operation may keep per buffer pool instance
+   */
+  BufferAccessStrategy(AccessStrategyType type, size_t ring_size);
+
+  ~BufferAccessStrategy() = default;
+
+  DISALLOW_COPY(BufferAccessStrategy);
+
+  /** @return the kind of bulk access */
+  AccessStrategyType GetType() const { return type_; }
+
+  /** @return number of frames the operation may keep per buffer pool instance */
+  size_t GetRingSize() const { return ring_size_; }
+
+  /** 256 KB worth of pages, enough to keep a scan's reads streaming without holding on to much of the pool. */
+  static constexpr size_t BULK_READ_RING_SIZE = 256 * 1024 / PAGE_SIZE;
+  /**
+   * A scan keeps the page it is on pinned while it fetches the next one, so a ring needs room for both plus a frame
+   * to recycle; anything smaller would fall back to the shared pool on every miss.
+   */
+  static constexpr size_t MIN_RING_SIZE = 4;
+
+ private:
+  /** A frame that the operation loaded a page into. */
+  struct Slot {
+    frame_id_t frame_id_{-1};
+    page_id_t page_id_{INVALID_PAGE_ID};
+  };
+
+  /** Frames are per instance, so a ParallelBufferPoolManager scan keeps one ring per instance. */
+  struct Ring {
+    const void *owner_;
+    std::vector<Slot> slots_;
+    size_t next_{0};
+  };
+
+  /**
+   * @param owner the buffer pool instance
+   * @param pool_size number of frames of that instance; a ring takes at most an eighth of them, but never fewer than
+   * MIN_RING_SIZE frames unless the pool itself is smaller
+   * @return the ring of the given buffer pool instance, created on first use
+   */
+  Ring *GetRing(const void *owner, size_t pool_size);
+
+  const AccessStrategyType type_;
+  const size_t ring_size_;
+  std::vector<Ring> rings_;
+};
+
+}  // namespace bustub
@@ -15,11 +15,14 @@
 #include <list>
 #include <mutex>  // NOLINT
 #include <unordered_map>
+#include <vector>
 
+#include "buffer/buffer_access_strategy.h"
 #include "buffer/lru_replacer.h"
 #include "recovery/log_manager.h"
 #include "storage/disk/disk_manager.h"
 #include "storage/page/page.h"
+#include "storage/page/page_guard.h"
 
 namespace bustub {
 
@@ -84,6 +87,89 @@ class BufferPoolManager {
     GradingCallback(callback, CallbackType::AFTER, INVALID_PAGE_ID);
   }
 
+  /**
+   * Fetch a page on behalf of a bulk operation. A miss recycles one of the strategy's ring frames instead of evicting
+   * a page of the shared pool, see BufferAccessStrategy.
+   * @param page_id id of page to be fetched
+   * @param strategy the operation's access strategy, nullptr behaves like FetchPage
+   * @return the requested page
+   */
+  Page *FetchPageWithStrategy(page_id_t page_id, BufferAccessStrategy *strategy) {
+    return FetchPgStrategyImp(page_id, strategy);
+  }
+
+  /**
+   * Create a new page on behalf of a bulk operation, taking its frame from the strategy's ring when possible.
+   * @param[out] page_id id of created page
+   * @param strategy the operation's access strategy, nullptr behaves like NewPage
+   * @return nullptr if no new pages could be created, otherwise pointer to new page
+   */
+  Page *NewPageWithStrategy(page_id_t *page_id, BufferAccessStrategy *strategy) {
+    return NewPgStrategyImp(page_id, strategy);
+  }
+
+  /**
+   * Fetch a page and return a guard that unpins it when it goes out of scope.
+   * @param page_id id of page to be fetched
+   * @param strategy access strategy of a bulk operation, may be nullptr
+   * @return a guard on the requested page, empty if the page could not be fetched
+   */
+  BasicPageGuard FetchPageBasic(page_id_t page_id, BufferAccessStrategy *strategy = nullptr) {
+    return {this, FetchPageWithStrategy(page_id, strategy)};
+  }
+
+  /**
+   * Fetch and read latch a page, and return a guard that unlatches and unpins it when it goes out of scope.
+   * @param page_id id of page to be fetched
+   * @param strategy access strategy of a bulk operation, may be nullptr
+   * @return a guard on the requested page, empty if the page could not be fetched
+   */
+  ReadPageGuard FetchPageRead(page_id_t page_id, BufferAccessStrategy *strategy = nullptr) {
+    return FetchPageBasic(page_id, strategy).UpgradeRead();
+  }
+
+  /**
+   * Fetch and write latch a page, and return a guard that unlatches and unpins it when it goes out of scope.
+   * @param page_id id of page to be fetched
+   * @param strategy access strategy of a bulk operation, may be nullptr
+   * @return a guard on the requested page, empty if the page could not be fetched
+   */
+  WritePageGuard FetchPageWrite(page_id_t page_id, BufferAccessStrategy *strategy = nullptr) {
+    return FetchPageBasic(page_id, strategy).UpgradeWrite();
+  }
+
+  /**
+   * Create a new page and return a guard that unpins it when it goes out of scope. The page is new, so it is always
+   * unpinned dirty.
+   * @param[out] page_id id of created page
+   * @param strategy access strategy of a bulk operation, may be nullptr
+   * @return a guard on the new page, empty if no new pages could be created
+   */
+  BasicPageGuard NewPageGuarded(page_id_t *page_id, BufferAccessStrategy *strategy = nullptr) {
+    BasicPageGuard guard(this, NewPageWithStrategy(page_id, strategy));
+    if (guard.IsValid()) {
+      guard.SetDirty();
+    }
+    return guard;
+  }
+
+  /**
+   * Ask the buffer pool to read a page in the background, so that a later FetchPage finds it resident. This is only a
+   * hint: the page is not pinned, and the request is dropped if the page is already resident or the pool is busy.
+   * @param page_id id of the page that will be fetched soon
+   */
+  void PrefetchPage(page_id_t page_id) { PrefetchPgImp(page_id); }
+
+  /**
+   * Ask the buffer pool to read several pages in the background, see PrefetchPage.
+   * @param page_ids ids of the pages that will be fetched soon, in the order they will be fetched
+   */
+  void PrefetchPages(const std::vector<page_id_t> &page_ids) {
+    for (page_id_t page_id : page_ids) {
+      PrefetchPgImp(page_id);
+    }
+  }
+
   /** @return size of the buffer pool */
   virtual size_t GetPoolSize() = 0;
 
@@ -108,6 +194,21 @@ class BufferPoolManager {
    */
   virtual Page *FetchPgImp(page_id_t page_id) = 0;
 
+  /**
+   * Fetch the requested page from the buffer pool, recycling the strategy's ring frames on a miss. Buffer pools that
+   * do not support access strategies ignore the strategy.
+   * @param page_id id of page to be fetched
+   * @param strategy access strategy of a bulk operation, may be nullptr
+   * @return the requested page
+   */
+  virtual Page *FetchPgStrategyImp(page_id_t page_id, BufferAccessStrategy *strategy) { return FetchPgImp(page_id); }
+
+  /**
+   * Schedule a background read of the requested page. Buffer pools without background I/O ignore the request.
+   * @param page_id id of page to be prefetched
+   */
+  virtual void PrefetchPgImp(page_id_t page_id) {}
+
   /**
    * Unpin the target page from the buffer pool.
    * @param page_id id of page to be unpinned
@@ -130,6 +231,15 @@ class BufferPoolManager {
    */
   virtual Page *NewPgImp(page_id_t *page_id) = 0;
 
+  /**
+   * Creates a new page in the buffer pool, taking its frame from the strategy's ring when possible. Buffer pools that
+   * do not support access strategies ignore the strategy.
+   * @param[out] page_id id of created page
+   * @param strategy access strategy of a bulk operation, may be nullptr
+   * @return nullptr if no new pages could be created, otherwise pointer to new page
+   */
+  virtual Page *NewPgStrategyImp(page_id_t *page_id, BufferAccessStrategy *strategy) { return NewPgImp(page_id); }
+
   /**
    * Deletes a page from the buffer pool.
    * @param page_id id of page to be deleted
@@ -12,12 +12,27 @@
 
 #pragma once
 
+#include <array>
+#include <atomic>
+#include <chrono>  // NOLINT
+#include <condition_variable>  // NOLINT
+#include <deque>
 #include <list>
+#include <memory>
 #include <mutex>  // NOLINT
+#include <thread>  // NOLINT
 #include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
 
 #include "buffer/buffer_pool_manager.h"
-#include "buffer/lru_replacer.h"
+#include "buffer/buffer_pool_options.h"
+#include "buffer/buffer_pool_stats.h"
+#include "buffer/compressed_page_tier.h"
+#include "buffer/frame_arena.h"
+#include "buffer/page_table.h"
+#include "buffer/replacer.h"
 #include "recovery/log_manager.h"
 #include "storage/disk/disk_manager.h"
 #include "storage/page/page.h"
@@ -34,8 +49,10 @@ class BufferPoolManagerInstance : public BufferPoolManager {
    * @param pool_size the size of the buffer pool
    * @param disk_manager the disk manager
    * @param log_manager the log manager (for testing only: nullptr = disable logging)
+   * @param options tunables such as the replacement policy
    */
-  BufferPoolManagerInstance(size_t pool_size, DiskManager *disk_manager, LogManager *log_manager = nullptr);
+  BufferPoolManagerInstance(size_t pool_size, DiskManager *disk_manager, LogManager *log_manager = nullptr,
+                            const BufferPoolOptions &options = BufferPoolOptions());
   /**
    * Creates a new BufferPoolManagerInstance.
    * @param pool_size the size of the buffer pool
@@ -43,9 +60,11 @@ class BufferPoolManagerInstance : public BufferPoolManager {
    * @param instance_index index of this BPI in the parallel BPM
    * @param disk_manager the disk manager
    * @param log_manager the log manager (for testing only: nullptr = disable logging)
+   * @param options tunables such as the replacement policy
    */
   BufferPoolManagerInstance(size_t pool_size, uint32_t num_instances, uint32_t instance_index,
-                            DiskManager *disk_manager, LogManager *log_manager = nullptr);
+                            DiskManager *disk_manager, LogManager *log_manager = nullptr,
+                            const BufferPoolOptions &options = BufferPoolOptions());
 
   /**
    * Destroys an existing BufferPoolManagerInstance.
@@ -55,9 +74,62 @@ class BufferPoolManagerInstance : public BufferPoolManager {
   /** @return size of the buffer pool */
   size_t GetPoolSize() override { return pool_size_; }
 
+  /** @return the largest size the buffer pool can be resized to */
+  size_t GetMaxPoolSize() const { return max_pool_size_; }
+
+  /** @return the NUMA node the frames are bound to, -1 if they are not bound */
+  int GetNumaNode() const { return options_.numa_node_; }
+
+  /**
+   * Grow or shrink the buffer pool while it is in use. Growing adds empty frames. Shrinking stops placing pages in the
+   * frames beyond the new size, then evicts their pages (writing back dirty ones) as soon as they are unpinned and
+   * releases the frames' memory. Pages keep their address for as long as they stay in the pool.
+   * @param new_pool_size the new number of frames, at most GetMaxPoolSize()
+   * @param timeout how long a shrink waits for pinned pages to be unpinned
+   * @return false if new_pool_size is out of range, or if the shrink timed out and the pool kept its old size
+   */
+  bool Resize(size_t new_pool_size, std::chrono::milliseconds timeout = std::chrono::seconds(1));
+
   /** @return pointer to all the pages in the buffer pool */
   Page *GetPages() { return pages_; }
 
+  /** @return number of evictions that had to write a dirty victim back on the evicting thread */
+  size_t GetSyncEvictionWrites() const { return sync_eviction_writes_; }
+
+  /** @return number of pages written back by the background writer */
+  size_t GetBackgroundWrites() const { return bg_writes_; }
+
+  /**
+   * Take a snapshot of the counters of this instance: hits, misses, evictions, write-backs, time spent waiting for
+   * latch_ and the heat histogram of the pages it held. Cheap enough to poll, but briefly takes latch_.
+   */
+  BufferPoolStats GetStats();
+
+  /**
+   * Collect the dirty pages of this instance for a checkpoint, after waiting for the write-back of evicted pages. Only
+   * takes the page table's shard latches and pins nothing, so fetches go on meanwhile. Hand the pages to
+   * WriteDirtyPages.
+   * @param[out] dirty_pages the pages are appended here, with this instance
+   */
+  void CollectDirtyPages(std::vector<std::pair<page_id_t, BufferPoolManagerInstance *>> *dirty_pages);
+
+  /**
+   * Write back the pages collected by CollectDirtyPages in page id order, one write per run of adjacent page ids, then
+   * sync the database file once. Each page is pinned only while it is copied out under its read latch and marked
+   * clean, and stays under writeback until its run is written, so a re-read of an evicted page waits for the write.
+   * No buffer pool latch is held.
+   * @param disk_manager the disk manager of the pages
+   * @param dirty_pages the pages and the instances holding them; sorted in place
+   */
+  static void WriteDirtyPages(DiskManager *disk_manager,
+                              std::vector<std::pair<page_id_t, BufferPoolManagerInstance *>> *dirty_pages);
+
+  /** Longest run of pages WriteDirtyPages writes at once. */
+  static constexpr size_t FLUSH_BATCH_PAGES = 32;
+
+  /** @return the compressed page tier, nullptr if compressed_tier_bytes_ is 0 */
+  CompressedPageTier *GetCompressedTier() { return compressed_tier_.get(); }
+
  protected:
   /**
    * Fetch the requested page from the buffer pool.
@@ -66,6 +138,20 @@ class BufferPoolManagerInstance : public BufferPoolManager {
    */
   Page *FetchPgImp(page_id_t page_id) override;
 
+  /**
+   * Fetch the requested page from the buffer pool, recycling the strategy's ring frames on a miss.
+   * @param page_id id of page to be fetched
+   * @param strategy access strategy of a bulk operation, may be nullptr
+   * @return the requested page
+   */
+  Page *FetchPgStrategyImp(page_id_t page_id, BufferAccessStrategy *strategy) override;
+
+  /**
+   * Queue the requested page for the prefetch threads, unless it is already resident.
+   * @param page_id id of page to be prefetched
+   */
+  void PrefetchPgImp(page_id_t page_id) override;
+
   /**
    * Unpin the target page from the buffer pool.
    * @param page_id id of page to be unpinned
@@ -89,30 +175,38 @@ class BufferPoolManagerInstance : public BufferPoolManager {
   Page *NewPgImp(page_id_t *page_id) override;
 
   /**
-   * Deletes a page from the buffer pool.
+   * Creates a new page in the buffer pool, taking its frame from the strategy's ring when possible.
+   * @param[out] page_id id of created page
+   * @param strategy access strategy of a bulk operation, may be nullptr
+   * @return nullptr if no new pages could be created, otherwise pointer to new page
+   */
+  Page *NewPgStrategyImp(page_id_t *page_id, BufferAccessStrategy *strategy) override;
+
+  /**
+   * Deletes a page from the buffer pool and deallocates it, so that a later NewPage of this instance can reuse its id.
    * @param page_id id of page to be deleted
    * @return false if the page exists but could not be deleted, true if the page didn't exist or deletion succeeded
    */
   bool DeletePgImp(page_id_t page_id) override;
 
   /**
-   * Flushes all the pages in the buffer pool to disk.
+   * Flushes all the dirty pages in the buffer pool to disk, see CollectDirtyPages and WriteDirtyPages.
    */
   void FlushAllPgsImp() override;
 
   /**
-   * Allocate a page on disk.∂
+   * Allocate a page on disk: a page of this instance freed earlier if the disk manager has one, otherwise the next
+   * unused id of this instance.
+   * @param[out] reused set to true if the id is a freed page, whose old content is still in the file; may be nullptr
    * @return the id of the allocated page
    */
-  page_id_t AllocatePage();
+  page_id_t AllocatePage(bool *reused = nullptr);
 
   /**
-   * Deallocate a page on disk.
+   * Deallocate a page on disk, handing it to the disk manager's free list.
    * @param page_id id of the page to deallocate
    */
-  void DeallocatePage(__attribute__((unused)) page_id_t page_id) {
-    // This is a no-nop right now without a more complex data structure to track deallocated pages
-  }
+  void DeallocatePage(page_id_t page_id);
 
   /**
    * Validate that the page_id being used is accessible to this BPI. This can be used in all of the functions to
@@ -121,8 +215,150 @@ class BufferPoolManagerInstance : public BufferPoolManager {
    */
   void ValidatePageId(page_id_t page_id) const;
 
-  /** Number of pages in the buffer pool. */
-  const size_t pool_size_;
+  /**
+   * Pick a frame to hold a new page, from the free list first and then from the replacer. The victim's page table
+   * entry is removed. A dirty victim is registered as under writeback, and the caller must write it back with
+   * FinishWriteback before reusing the frame. The caller must hold latch_.
+   * @param[out] frame_id the frame that can be reused
+   * @param[out] writeback_page_id the dirty victim to write back, INVALID_PAGE_ID if the frame is clean
+   * @return false if every frame is pinned
+   */
+  bool FindReplacementFrame(frame_id_t *frame_id, page_id_t *writeback_page_id);
+
+  /**
+   * Recycle the oldest frame of the strategy's ring, provided it still holds the page the strategy loaded into it
+   * and nobody has it pinned. A dirty page is handled as in FindReplacementFrame. The caller must hold latch_.
+   * @param strategy the access strategy of a bulk operation
+   * @param[out] frame_id the frame that can be reused
+   * @param[out] writeback_page_id the dirty page to write back, INVALID_PAGE_ID if the frame is clean
+   * @return false if the ring is not full yet or its oldest frame cannot be recycled
+   */
+  bool TakeRingFrame(BufferAccessStrategy *strategy, frame_id_t *frame_id, page_id_t *writeback_page_id);
+
+  /**
+   * Record that the strategy loaded page_id into frame_id, replacing the ring's oldest slot. The caller must hold
+   * latch_.
+   */
+  void PutRingFrame(BufferAccessStrategy *strategy, frame_id_t frame_id, page_id_t page_id);
+
+  /**
+   * A strategy fetch hit a page that a prefetch thread read into the shared pool. Move the page's frame into the
+   * strategy's ring, giving the ring's oldest frame back to the free list, so that read-ahead does not defeat the
+   * ring. The caller must have the page pinned and must not hold latch_.
+   */
+  void AdoptRingFrame(BufferAccessStrategy *strategy, frame_id_t frame_id, page_id_t page_id);
+
+  /**
+   * Give a frame that holds no page back to the free list, unless Resize is retiring it. The caller must hold latch_.
+   */
+  void ReturnFrame(frame_id_t frame_id);
+
+  /**
+   * Evict the unpinned pages held by the frames in [begin, end), which Resize is retiring. The caller must hold latch_.
+   * @return true if none of these frames holds a page anymore
+   */
+  bool DrainFrames(size_t begin, size_t end);
+
+  /** Record that page_id was evicted dirty and is about to be written back. The caller must hold latch_. */
+  void BeginWriteback(page_id_t page_id);
+
+  /** Remove one writeback of page_id from the pages under writeback and wake up whoever waits for it. */
+  void EndWriteback(page_id_t page_id);
+
+  /** @return true if page_id has a writeback or compressed tier admission that has not finished yet */
+  bool IsUnderWriteback(page_id_t page_id);
+
+  /** What CopyDirtyPage did with a page. */
+  enum class FlushCopyResult { COPIED, SKIPPED, BUSY };
+
+  /**
+   * Copy page_id out for WriteDirtyPages, mark it clean and register it as being flushed until EndFlush. The page is
+   * pinned only for the copy.
+   * @param page_id the page to copy
+   * @param[out] data where the page is copied to
+   * @param wait whether to block on the page's read latch, see BUSY
+   * @return COPIED if the page was copied, SKIPPED if it is no longer resident and dirty, BUSY if the page's latch is
+   * taken and wait is false, or an earlier flush of the page has not been written yet
+   */
+  FlushCopyResult CopyDirtyPage(page_id_t page_id, char *data, bool wait);
+
+  /** Remove page_id from the pages being flushed and wake up whoever waits for it. */
+  void EndFlush(page_id_t page_id);
+
+  /** Block until no flush of page_id copied out earlier is waiting to be written. */
+  void WaitForFlush(page_id_t page_id);
+
+  /** @return true if a flush has copied out page_id and not written it yet */
+  bool IsFlushing(page_id_t page_id);
+
+  /**
+   * Start offering the clean page page_id, evicted from frame_id, to the disk manager's page cache and to the
+   * compressed tier. A page bound for the compressed tier is registered as under writeback, so that it is not read
+   * back from disk before it is in the tier. FinishWriteback copies the page. The caller must hold latch_.
+   */
+  void BeginCacheAdmission(frame_id_t frame_id, page_id_t page_id);
+
+  /**
+   * Write back the evicted page page_id, whose content is still in frame_id, put it in the compressed tier and wake up
+   * whoever waits for it. Does nothing if page_id is INVALID_PAGE_ID. Also copies a clean victim of frame_id into the
+   * page cache and the compressed tier, see BeginCacheAdmission. Called without latch_.
+   */
+  void FinishWriteback(frame_id_t frame_id, page_id_t page_id);
+
+  /** Acquire latch_, adding the time spent waiting for it to the latch wait counters if it was contended. */
+  std::unique_lock<std::mutex> LockLatch();
+
+  /** Count a fetch of the page in frame_id in the frame's heat, if this fetch is sampled. */
+  void RecordAccess(frame_id_t frame_id);
+
+  /** Count the eviction of the page in frame_id and move the frame's heat into the histogram. */
+  void RecordEviction(frame_id_t frame_id);
+
+  /**
+   * Block until page_id is neither under writeback nor being flushed, or until no page is if page_id is INVALID_PAGE_ID.
+   */
+  void WaitForWriteback(page_id_t page_id);
+
+  /** Block until the frame, which the caller has pinned, is done being read or initialized. */
+  void WaitForIo(frame_id_t frame_id);
+
+  /** Clear the I/O in progress state of a frame and wake up whoever waits for it. */
+  void FinishIo(frame_id_t frame_id);
+
+  /**
+   * Bring page_id into frame_id, which is already in the page table with I/O in progress: write back the frame's
+   * dirty victim, wait for any pending writeback of page_id, take the page from the compressed tier or read it from
+   * disk and finish the I/O. Called without latch_.
+   */
+  void LoadFrame(frame_id_t frame_id, page_id_t page_id, page_id_t writeback_page_id);
+
+  /** Body of the prefetch threads: serve prefetch_queue_ until the instance is destroyed. */
+  void PrefetchThreadMain();
+
+  /**
+   * Read a page into an unpinned frame, unless it is already resident or every frame is pinned. Called by the
+   * prefetch threads.
+   */
+  void InstallPrefetchedPage(page_id_t page_id);
+
+  /** Body of the background writer thread: run CleanVictimCandidates every bg_writer_interval_. */
+  void BackgroundWriterMain();
+
+  /**
+   * Write back the dirty pages among the first bg_writer_clean_ratio_ of the replacer's eviction candidates, in page
+   * id order. The pages are pinned for the duration of the write without telling the replacer, so they keep their
+   * place in the eviction order.
+   */
+  void CleanVictimCandidates();
+
+  /** Number of pages in the buffer pool. Frames at or beyond it never receive a page. Changed under latch_. */
+  std::atomic<size_t> pool_size_;
+  /** Number of frames the address space was reserved for. */
+  const size_t max_pool_size_;
+  /** Serializes calls to Resize. */
+  std::mutex resize_latch_;
+  /** Tunables this instance was created with. */
+  const BufferPoolOptions options_;
   /** How many instances are in the parallel BPM (if present, otherwise just 1 BPI) */
   const uint32_t num_instances_ = 1;
   /** Index of this BPI in the parallel BPM (if present, otherwise just 0) */
@@ -130,20 +366,92 @@ class BufferPoolManagerInstance : public BufferPoolManager {
   /** Each BPI maintains its own counter for page_ids to hand out, must ensure they mod back to its instance_index_ */
   std::atomic<page_id_t> next_page_id_ = instance_index_;
 
-  /** Array of buffer pool pages. */
+  /** Payloads of the frames, one PAGE_SIZE slot per frame up to max_pool_size_. */
+  FrameArena arena_;
+  /** Array of buffer pool pages, the bookkeeping of each frame. Its data points into arena_. */
   Page *pages_;
   /** Pointer to the disk manager. */
   DiskManager *disk_manager_ __attribute__((__unused__));
   /** Pointer to the log manager. */
   LogManager *log_manager_ __attribute__((__unused__));
-  /** Page table for keeping track of buffer pool pages. */
-  std::unordered_map<page_id_t, frame_id_t> page_table_;
-  /** Replacer to find unpinned pages for replacement. */
+  /**
+   * Page table for keeping track of buffer pool pages. It is sharded and latched on its own, so that a hit only
+   * touches one shard latch and the page's atomic pin count.
+   */
+  PageTable page_table_;
+  /**
+   * Replacer to find unpinned pages for replacement. Hits pin and unpin frames without latch_, so the replacer may
+   * briefly hold a frame that has been pinned again; eviction re-checks the pin count under the shard latch.
+   */
   Replacer *replacer_;
   /** List of free pages. */
   std::list<frame_id_t> free_list_;
-  /** This latch protects shared data structures. We recommend updating this comment to describe what it protects. */
+  /**
+   * This latch serializes misses, allocation, deletion and flushing: it protects free_list_, the page_id_ of every
+   * frame and the choice of victims. It is never taken on a page table hit or on unpin, and it is not held while a
+   * miss reads its page or writes back its victim.
+   */
   std::mutex latch_;
-  
+
+  /**
+   * Per frame, true while the frame's page is being read from disk (or zeroed, for a new page). The frame is already
+   * in the page table and pinned by the thread doing the I/O, so concurrent fetchers of the page pin it and wait.
+   */
+  std::unique_ptr<std::atomic<bool>[]> io_in_progress_;
+  /** Evicted pages whose writeback or compressed tier admission has not finished yet, once per writeback in flight. */
+  std::unordered_multiset<page_id_t> writeback_pages_;
+  /** Pages copied out by a flush that is still writing them. Older content, so a newer write must wait for it. */
+  std::unordered_set<page_id_t> flushing_pages_;
+  /** Protects writeback_pages_, flushing_pages_ and the transitions of io_in_progress_ to false. */
+  std::mutex io_latch_;
+  /** Signalled whenever a writeback or a read finishes. */
+  std::condition_variable io_cv_;
+
+  /** A clean victim on its way into the disk manager's page cache and the compressed tier. */
+  struct CacheAdmission {
+    page_id_t page_id_{INVALID_PAGE_ID};
+    /** Ticket of LocalPageCache::BeginAdmit, 0 if there is nothing to copy. */
+    uint64_t ticket_{0};
+    /** True if the page goes to the compressed tier, and is under writeback until it is there. */
+    bool compress_{false};
+  };
+  /**
+   * Per frame, the clean victim to copy into the page cache and the compressed tier. Owned by the thread that evicted
+   * it, like the frame.
+   */
+  std::unique_ptr<CacheAdmission[]> cache_admissions_;
+  /** Evicted pages kept compressed in memory, nullptr if the tier is off. */
+  std::unique_ptr<CompressedPageTier> compressed_tier_;
+
+  /** Per frame, true from the moment a prefetch thread installs a page until the page is first fetched. */
+  std::unique_ptr<std::atomic<bool>[]> prefetched_;
+  /** Pages waiting to be read by the prefetch threads, at most pool_size_ of them. */
+  std::deque<page_id_t> prefetch_queue_;
+  /** Protects prefetch_queue_ and stop_prefetch_. */
+  std::mutex prefetch_latch_;
+  std::condition_variable prefetch_cv_;
+  bool stop_prefetch_{false};
+  std::vector<std::thread> prefetch_threads_;
+
+  /** Dirty victims written back by the thread that evicted them. */
+  std::atomic<size_t> sync_eviction_writes_{0};
+  /** Pages written back by the background writer. */
+  std::atomic<size_t> bg_writes_{0};
+  /** Counters behind GetStats. The ones bumped on the hit path are sharded, the others are bumped under latch_. */
+  ShardedCounter hits_;
+  ShardedCounter misses_;
+  ShardedCounter latch_waits_;
+  ShardedCounter latch_wait_ns_;
+  std::atomic<uint64_t> evictions_{0};
+  /** Per frame, the number of sampled fetches of the page it holds. */
+  std::unique_ptr<std::atomic<uint32_t>[]> heat_;
+  /** Heat histogram of the pages evicted so far, see BufferPoolStats::heat_histogram_. */
+  std::array<std::atomic<uint64_t>, BufferPoolStats::HEAT_BUCKETS> evicted_heat_{};
+  /** Protects stop_bg_writer_. */
+  std::mutex bg_writer_latch_;
+  std::condition_variable bg_writer_cv_;
+  bool stop_bg_writer_{false};
+  /** Runs only if bg_writer_clean_ratio_ is positive. */
+  std::thread bg_writer_;
 };
 }  // namespace bustub
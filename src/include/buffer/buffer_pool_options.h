@@ -0,0 +1,80 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// buffer_pool_options.h
+//
+// Identification: src/include/buffer/buffer_pool_options.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <chrono>  // NOLINT
+#include <cstddef>
+
+#include "buffer/replacer.h"
+#include "common/config.h"
+
+namespace bustub {
+
+/**
+ * BufferPoolOptions holds the tunables of a BufferPoolManagerInstance. A ParallelBufferPoolManager hands the same
+ * options to each of its instances. The defaults reproduce the behaviour of a plain LRU buffer pool.
+ */
+struct BufferPoolOptions {
+  /** Replacement policy used to pick victims. */
+  ReplacerType replacer_type_{ReplacerType::LRU};
+  /** K of the LRU-K replacer. */
+  size_t lru_k_{2};
+  /**
+   * Correlated reference period of the LRU-K replacer: references to a page within this long of its last counted one
+   * are folded into it. The default matches LRUKReplacer::DEFAULT_CORRELATED_PERIOD; 0 counts every reference.
+   */
+  std::chrono::microseconds lru_k_correlated_period_{1000};
+  /**
+   * Largest size BufferPoolManagerInstance::Resize may grow the pool to, in frames. Address space for that many frames
+   * is reserved up front; memory is only used by the frames in use. Values below the initial pool size are ignored.
+   */
+  size_t max_pool_size_{0};
+  /**
+   * Back the frames with huge pages: MAP_HUGETLB if the system has huge pages reserved, transparent huge pages
+   * otherwise. Cuts TLB misses on large pools, at the cost of committing memory in huge page units.
+   */
+  bool huge_pages_{false};
+  /** NUMA node the frames are bound to, -1 leaves their placement to the operating system. See NumaUtil. */
+  int numa_node_{-1};
+  /**
+   * Only used by ParallelBufferPoolManager: spread the instances over the NUMA nodes, binding instance i to node
+   * i % number of nodes, and start every NewPage at an instance on the calling thread's node. Overrides numa_node_.
+   */
+  bool numa_aware_{false};
+  /**
+   * Only used by ParallelBufferPoolManager: start every NewPage of a thread at that thread's home instance instead of
+   * at the next instance in round-robin order, so that threads allocating pages concurrently do not share latches.
+   */
+  bool new_page_thread_affinity_{false};
+  /** Number of background threads serving PrefetchPage requests. 0, the default, turns prefetching off. */
+  size_t prefetch_threads_{0};
+  /**
+   * Fraction of the replacer's eviction candidates, between 0 and 1, that the background writer keeps clean. 0 turns
+   * the background writer off, and a dirty victim is written back by the thread that evicts it.
+   */
+  double bg_writer_clean_ratio_{0};
+  /** Pause between two rounds of the background writer. */
+  std::chrono::milliseconds bg_writer_interval_{10};
+  /**
+   * Sample one in this many fetches of each thread for the heat histogram of BufferPoolStats. 0 turns sampling off;
+   * the other counters are always kept.
+   */
+  size_t stats_sample_interval_{64};
+  /**
+   * Memory budget of the compressed page tier, in bytes of compressed data per instance. Evicted pages that compress
+   * well are kept there, and a miss decompresses them instead of reading the disk. 0 turns the tier off.
+   */
+  size_t compressed_tier_bytes_{0};
+};
+
+}  // namespace bustub
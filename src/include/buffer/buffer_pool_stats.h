@@ -0,0 +1,116 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// buffer_pool_stats.h
+//
+// Identification: src/include/buffer/buffer_pool_stats.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace bustub {
+
+/**
+ * ShardedCounter is a counter that many threads can bump without sharing a cache line: every thread adds to its own
+ * shard, and reading the counter sums the shards. Reads are not synchronized with concurrent adds.
+ */
+class ShardedCounter {
+ public:
+  /** Add n to the counter. */
+  void Add(uint64_t n = 1) { shards_[ThreadShard()].value_.fetch_add(n, std::memory_order_relaxed); }
+
+  /** @return the sum of all adds so far */
+  uint64_t Sum() const {
+    uint64_t sum = 0;
+    for (const auto &shard : shards_) {
+      sum += shard.value_.load(std::memory_order_relaxed);
+    }
+    return sum;
+  }
+
+ private:
+  static constexpr size_t NUM_SHARDS = 16;
+
+  struct alignas(64) Shard {
+    std::atomic<uint64_t> value_{0};
+  };
+
+  /** @return the shard of the calling thread. Threads are assigned shards round-robin on first use. */
+  static size_t ThreadShard() {
+    static std::atomic<size_t> next_shard{0};
+    static thread_local const size_t shard = next_shard.fetch_add(1, std::memory_order_relaxed) % NUM_SHARDS;
+    return shard;
+  }
+
+  std::array<Shard, NUM_SHARDS> shards_;
+};
+
+/**
+ * BufferPoolStats is a snapshot of the counters of a buffer pool, see BufferPoolManagerInstance::GetStats. Counters
+ * count from the creation of the pool; diff two snapshots to get the activity in between.
+ */
+struct BufferPoolStats {
+  /** Buckets of the heat histogram: bucket 0 is pages without sampled accesses, bucket i holds [2^(i-1), 2^i). */
+  static constexpr size_t HEAT_BUCKETS = 24;
+
+  /** Fetches that found their page in the pool, including pages read ahead by PrefetchPage. */
+  uint64_t hits_{0};
+  /** Fetches that had to read their page (or failed because every frame was pinned). */
+  uint64_t misses_{0};
+  /** Pages evicted to make room for another page, or by a shrinking Resize. */
+  uint64_t evictions_{0};
+  /** Dirty victims written back by the thread that evicted them. */
+  uint64_t sync_writes_{0};
+  /** Dirty pages written back by the background writer. */
+  uint64_t bg_writes_{0};
+  /** Acquisitions of the instance latch that had to wait. */
+  uint64_t latch_waits_{0};
+  /** Total time spent waiting for the instance latch, in nanoseconds. */
+  uint64_t latch_wait_ns_{0};
+  /**
+   * Sampled access frequency of pages: every page that was evicted or is resident is counted in the bucket of the
+   * number of its sampled fetches (one in BufferPoolOptions::stats_sample_interval_ of each thread's fetches).
+   */
+  std::array<uint64_t, HEAT_BUCKETS> heat_histogram_{};
+
+  /** @return hits / (hits + misses), 0 if there were no fetches */
+  double HitRatio() const {
+    return hits_ + misses_ == 0 ? 0 : static_cast<double>(hits_) / static_cast<double>(hits_ + misses_);
+  }
+
+  /** @return the bucket of the heat histogram a page with the given number of sampled accesses falls into */
+  static size_t HeatBucket(uint64_t accesses) {
+    size_t bucket = 0;
+    while (accesses != 0 && bucket + 1 < HEAT_BUCKETS) {
+      accesses >>= 1;
+      bucket++;
+    }
+    return bucket;
+  }
+
+  /** Add the counters of another pool, e.g. to sum up the instances of a ParallelBufferPoolManager. */
+  BufferPoolStats &operator+=(const BufferPoolStats &other) {
+    hits_ += other.hits_;
+    misses_ += other.misses_;
+    evictions_ += other.evictions_;
+    sync_writes_ += other.sync_writes_;
+    bg_writes_ += other.bg_writes_;
+    latch_waits_ += other.latch_waits_;
+    latch_wait_ns_ += other.latch_wait_ns_;
+    for (size_t i = 0; i < HEAT_BUCKETS; i++) {
+      heat_histogram_[i] += other.heat_histogram_[i];
+    }
+    return *this;
+  }
+};
+
+}  // namespace bustub
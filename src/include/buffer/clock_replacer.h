@@ -12,7 +12,8 @@
 
 #pragma once
 
-#include <list>
+#include <atomic>
+#include <memory>
 #include <mutex>  // NOLINT
 #include <vector>
 
@@ -23,6 +24,9 @@ namespace bustub {
 
 /**
  * ClockReplacer implements the clock replacement policy, which approximates the Least Recently Used policy.
+ *
+ * Every frame owns one byte holding an "in clock" bit and a reference bit. Pin and Unpin flip those bits with a single
+ * atomic operation and never allocate; only Victim, which moves the clock hand, takes a latch.
  */
 class ClockReplacer : public Replacer {
  public:
@@ -43,10 +47,26 @@ class ClockReplacer : public Replacer {
 
   void Unpin(frame_id_t frame_id) override;
 
+  void PeekVictims(size_t max_frames, std::vector<frame_id_t> *frames) override;
+
   size_t Size() override;
 
  private:
-  // TODO(student): implement me!
+  /** Set while the frame is unpinned, i.e. it may be victimized. */
+  static constexpr uint8_t IN_CLOCK = 0x1;
+  /** Set on unpin and cleared when the clock hand passes the frame, giving it a second chance. */
+  static constexpr uint8_t REFERENCED = 0x2;
+
+  /** Number of frames tracked by the clock. */
+  const size_t num_pages_;
+  /** Per-frame IN_CLOCK / REFERENCED bits, indexed by frame id. */
+  std::unique_ptr<std::atomic<uint8_t>[]> frames_;
+  /** Number of frames with IN_CLOCK set. */
+  std::atomic<size_t> size_{0};
+  /** Position of the clock hand. Protected by latch_. */
+  size_t hand_{0};
+  /** Serializes victim selection. */
+  std::mutex latch_;
 };
 
 }  // namespace bustub
@@ -0,0 +1,119 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// compressed_page_tier.h
+//
+// Identification: src/include/buffer/compressed_page_tier.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>  // NOLINT
+#include <unordered_map>
+
+#include "common/config.h"
+#include "common/macros.h"
+
+namespace bustub {
+
+/**
+ * CompressedPageTier keeps pages evicted from a buffer pool instance in memory, compressed with PageCodec, so that a
+ * later miss on them costs a decompression instead of a disk read. Partially filled pages compress several times
+ * over, so the same memory holds more pages than as frames.
+ *
+ * The tier is exclusive: Take removes the page, which then lives in a frame until it is evicted again, and the buffer
+ * pool never reads a page from disk while the tier has a copy of it. Every copy is therefore the latest content of
+ * its page. Pages are dropped in least recently put order once the compressed data outgrows the budget.
+ */
+class CompressedPageTier {
+ public:
+  /**
+   * Creates an empty tier.
+   * @param budget_bytes most bytes of compressed data the tier holds
+   */
+  explicit CompressedPageTier(size_t budget_bytes);
+
+  DISALLOW_COPY_AND_MOVE(CompressedPageTier);
+
+  /**
+   * Keep a copy of an evicted page. Pages that do not compress to at most MAX_RATIO of PAGE_SIZE are rejected.
+   * @param page_id id of the page
+   * @param page_data content of the page
+   * @return true if the page was kept
+   */
+  bool Put(page_id_t page_id, const char *page_data);
+
+  /**
+   * Remove a page from the tier.
+   * @param page_id id of the page
+   * @param[out] page_data the decompressed page, unspecified on a miss
+   * @return true if the tier had the page
+   */
+  bool Take(page_id_t page_id, char *page_data);
+
+  /** Drop the copy of a page, because it was deleted. */
+  void Erase(page_id_t page_id);
+
+  /** @return the memory budget, in bytes of compressed data */
+  size_t GetBudget() const { return budget_bytes_; }
+
+  /** @return bytes of compressed data held */
+  size_t GetBytesUsed() const { return bytes_used_; }
+
+  /** @return number of pages held */
+  size_t GetSize() const { return size_; }
+
+  /** @return number of pages kept by Put */
+  uint64_t GetPuts() const { return puts_; }
+
+  /** @return number of pages Put rejected because they did not compress well */
+  uint64_t GetRejected() const { return rejected_; }
+
+  /** @return number of Take calls that found their page */
+  uint64_t GetHits() const { return hits_; }
+
+  /** @return number of Take calls that did not find their page */
+  uint64_t GetMisses() const { return misses_; }
+
+  /** @return number of pages dropped to stay within the budget */
+  uint64_t GetBudgetEvictions() const { return budget_evictions_; }
+
+  /** Compressed size a page must not exceed, as a fraction of PAGE_SIZE. Worse pages are cheaper to read again. */
+  static constexpr double MAX_RATIO = 0.75;
+
+ private:
+  struct Entry {
+    page_id_t page_id_{INVALID_PAGE_ID};
+    size_t size_{0};
+    std::unique_ptr<char[]> data_;
+  };
+
+  /** Remove an entry from the tier. The caller must hold latch_. */
+  void EraseLocked(std::list<Entry>::iterator iter);
+
+  const size_t budget_bytes_;
+
+  /** Protects entries_ and index_. Compression and decompression run without it. */
+  std::mutex latch_;
+  /** Most recently put first. */
+  std::list<Entry> entries_;
+  std::unordered_map<page_id_t, std::list<Entry>::iterator> index_;
+
+  std::atomic<size_t> bytes_used_{0};
+  std::atomic<size_t> size_{0};
+  std::atomic<uint64_t> puts_{0};
+  std::atomic<uint64_t> rejected_{0};
+  std::atomic<uint64_t> hits_{0};
+  std::atomic<uint64_t> misses_{0};
+  std::atomic<uint64_t> budget_evictions_{0};
+};
+
+}  // namespace bustub
@@ -0,0 +1,82 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// frame_arena.h
+//
+// Identification: src/include/buffer/frame_arena.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstddef>
+
+#include "common/config.h"
+#include "common/macros.h"
+
+namespace bustub {
+
+/**
+ * FrameArena holds the payloads of the frames of a buffer pool: PAGE_SIZE bytes per frame, back to back in a single
+ * mapping. Every payload is aligned to PAGE_SIZE, so it can be handed to O_DIRECT reads and writes as is, and the
+ * bookkeeping of the frames (Page) lives in a separate array so that it does not interleave with the payloads.
+ *
+ * Address space is reserved for all frames up front, but memory is only committed when a frame is first touched. The
+ * mapping reads as zeros until then, and again after Release.
+ *
+ * With huge pages requested, the arena is first mapped with MAP_HUGETLB, which reserves huge pages for the whole arena
+ * at once. If the system does not have that many huge pages it falls back to a normal mapping aligned to the huge page
+ * size and asks for transparent huge pages instead.
+ */
+class FrameArena {
+ public:
+  /**
+   * Reserve the arena.
+   * @param num_frames number of frames the arena holds
+   * @param huge_pages back the arena with huge pages if the system allows it
+   * @throws Exception OUT_OF_MEMORY if the address space cannot be reserved
+   */
+  FrameArena(size_t num_frames, bool huge_pages);
+
+  /** Unmap the arena. */
+  ~FrameArena();
+
+  DISALLOW_COPY_AND_MOVE(FrameArena);
+
+  /** @return the payload of frame_id */
+  char *GetFrame(frame_id_t frame_id) const { return base_ + static_cast<size_t>(frame_id) * PAGE_SIZE; }
+
+  /**
+   * Give the memory of frames [begin, end) back to the operating system. Only whole pages of the mapping are
+   * released; the frames stay usable and read as zeros if their memory was released.
+   */
+  void Release(size_t begin, size_t end);
+
+  /** Place the memory of the arena on a NUMA node. Frames that have already been touched stay where they are. */
+  void BindToNode(int node);
+
+  /** @return true if the arena is mapped with MAP_HUGETLB */
+  bool IsHugeTlb() const { return huge_tlb_; }
+
+  /** @return the granularity at which memory is committed and released, in bytes */
+  size_t GetGranularity() const { return granularity_; }
+
+  /** Huge page size assumed for the alignment of the arena. */
+  static constexpr size_t HUGE_PAGE_SIZE = 2 * 1024 * 1024;
+
+ private:
+  /** Start of the arena, aligned to granularity_. */
+  char *base_;
+  /** Length of the arena, a multiple of granularity_. */
+  size_t length_;
+  /** Start and length of the whole mapping, which includes the alignment slack of the transparent huge page case. */
+  void *mapping_;
+  size_t mapping_length_;
+  size_t granularity_;
+  bool huge_tlb_{false};
+};
+
+}  // namespace bustub
@@ -0,0 +1,142 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// lru_k_replacer.h
+//
+// Identification: src/include/buffer/lru_k_replacer.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <chrono>  // NOLINT
+#include <list>
+#include <mutex>  // NOLINT
+#include <set>
+#include <tuple>
+#include <unordered_map>
+#include <vector>
+
+#include "buffer/replacer.h"
+#include "common/config.h"
+
+namespace bustub {
+
+/**
+ * LRUKReplacer implements the LRU-K replacement policy.
+ *
+ * Every Pin counts as a reference to the frame. The victim is the evictable frame whose K-th most recent reference is
+ * the oldest, i.e. the one with the largest backward K-distance. Frames with fewer than K references have an infinite
+ * backward K-distance and are evicted first, oldest first reference first. A page touched once by a sequential scan
+ * therefore never pushes out a page that has been referenced K times.
+ *
+ * References that arrive within the correlated reference period after the last counted reference to the same frame
+ * (e.g. the repeated fetches of one page by a single operation) are folded into it. The period is wall clock time, so
+ * how many other frames are referenced in between, for instance by concurrent queries, does not matter. A frame that
+ * is referenced continuously still gets a new reference once per period.
+ *
+ * When a page is evicted, its history is kept for a while, so that a page coming back soon after its eviction is not
+ * mistaken for one referenced for the first time. The replacer learns which page a frame holds through SetPage, and
+ * remembers the history of as many evicted pages as it has frames, dropping the oldest first.
+ */
+class LRUKReplacer : public Replacer {
+ public:
+  /**
+   * Create a new LRUKReplacer.
+   * @param num_pages the maximum number of pages the LRUKReplacer will be required to store
+   * @param k number of references used to compute the backward K-distance
+   * @param correlated_period references at most this long after the last counted one are folded into it; 0 counts
+   * every reference
+   */
+  explicit LRUKReplacer(size_t num_pages, size_t k = 2,
+                        std::chrono::nanoseconds correlated_period = DEFAULT_CORRELATED_PERIOD);
+
+  /**
+   * Destroys the LRUKReplacer.
+   */
+  ~LRUKReplacer() override;
+
+  bool Victim(frame_id_t *frame_id) override;
+
+  void Pin(frame_id_t frame_id) override;
+
+  void Unpin(frame_id_t frame_id) override;
+
+  void SetPage(frame_id_t frame_id, page_id_t page_id, bool new_page) override;
+
+  /** Unlike Pin, this does not count as a reference: the frame's history is dropped with its page. */
+  void Remove(frame_id_t frame_id) override;
+
+  void PeekVictims(size_t max_frames, std::vector<frame_id_t> *frames) override;
+
+  size_t Size() override;
+
+  /** Long enough to fold the fetches one operation makes of a page, short enough not to merge separate queries. */
+  static constexpr std::chrono::milliseconds DEFAULT_CORRELATED_PERIOD{1};
+
+ protected:
+  /** @return the current time, which the correlated reference period is measured in; simulations may override it */
+  virtual std::chrono::steady_clock::time_point Now() const { return std::chrono::steady_clock::now(); }
+
+ private:
+  /** Eviction order: frames with fewer than K references (0) before the others (1), then by timestamp. */
+  using EvictionKey = std::tuple<int, uint64_t, frame_id_t>;
+
+  /** Reference history of one frame. */
+  struct FrameHistory {
+    /** Number of uncorrelated references recorded, capped at K. */
+    size_t num_refs_{0};
+    /** Slot in history_ that receives the next reference. */
+    size_t next_slot_{0};
+    /** When the most recent uncorrelated reference happened. */
+    std::chrono::steady_clock::time_point last_counted_;
+    /** The page the frame holds, INVALID_PAGE_ID if unknown. */
+    page_id_t page_id_{INVALID_PAGE_ID};
+    /** True while the frame is in evictable_. */
+    bool evictable_{false};
+    /** The key the frame is stored under in evictable_. */
+    EvictionKey key_;
+  };
+
+  /** History of an evicted page. */
+  struct RetainedHistory {
+    FrameHistory frame_;
+    std::vector<uint64_t> refs_;
+    /** Position in retained_order_. */
+    std::list<page_id_t>::iterator order_;
+  };
+
+  /** Record a reference to frame_id at the current time. */
+  void RecordReference(frame_id_t frame_id);
+
+  /** Remember the history of the page frame_id is being evicted with, forgetting the oldest one if there is no room. */
+  void RetainHistory(frame_id_t frame_id);
+
+  /** @return the eviction key of frame_id, derived from its history */
+  EvictionKey MakeKey(frame_id_t frame_id) const;
+
+  /** @return timestamp of the i-th most recent uncorrelated reference of frame_id (0 is the most recent) */
+  uint64_t RecentReference(frame_id_t frame_id, size_t i) const;
+
+  const size_t num_pages_;
+  const size_t k_;
+  const std::chrono::nanoseconds correlated_period_;
+  /** Logical clock that orders references, advanced on every uncorrelated reference. */
+  uint64_t current_timestamp_{0};
+  /** Per-frame bookkeeping, indexed by frame id. */
+  std::vector<FrameHistory> frames_;
+  /** Ring buffers of the last K uncorrelated reference timestamps, K slots per frame. */
+  std::vector<uint64_t> history_;
+  /** Unpinned frames ordered by eviction priority. */
+  std::set<EvictionKey> evictable_;
+  /** Histories of evicted pages, at most num_pages_ of them. */
+  std::unordered_map<page_id_t, RetainedHistory> retained_;
+  /** Pages in retained_, the oldest eviction first. */
+  std::list<page_id_t> retained_order_;
+  std::mutex latch_;
+};
+
+}  // namespace bustub
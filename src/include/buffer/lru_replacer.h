@@ -12,10 +12,12 @@
 
 #pragma once
 
-#include <list>
+#include <atomic>
+#include <memory>
 #include <mutex>  // NOLINT
+#include <utility>
 #include <vector>
-#include <unordered_map>
+
 #include "buffer/replacer.h"
 #include "common/config.h"
 
@@ -23,6 +25,12 @@ namespace bustub {
 
 /**
  * LRUReplacer implements the Least Recently Used replacement policy.
+ *
+ * Every frame owns a stamp: 0 while the frame is pinned, otherwise the time it was unpinned. Pin and Unpin swap the
+ * stamp with a single atomic operation and never allocate, so buffer pool hits on different pages do not serialize
+ * here. Only Victim takes a latch: it sorts the unpinned frames by stamp once and hands them out oldest first until
+ * they run out, skipping the frames that were pinned or unpinned again since. Frames unpinned later have younger
+ * stamps, so the order is still exact LRU.
  */
 class LRUReplacer : public Replacer {
  public:
@@ -43,14 +51,26 @@ class LRUReplacer : public Replacer {
 
   void Unpin(frame_id_t frame_id) override;
 
+  void PeekVictims(size_t max_frames, std::vector<frame_id_t> *frames) override;
+
   size_t Size() override;
 
  private:
-  // TODO(student): implement me!
-  std::mutex mu;
-  std::list<frame_id_t> lru_cache; // 存放frame
-  std::unordered_map<frame_id_t, std::list<frame_id_t>::iterator> lru_hash; // 从frame到list的迭代器
-  size_t size;
+  /** Collect the unpinned frames with their stamps into candidates, the oldest last. */
+  void CollectCandidates(std::vector<std::pair<uint64_t, frame_id_t>> *candidates);
+
+  /** Number of frames tracked by the replacer. */
+  const size_t num_pages_;
+  /** Per-frame unpin time, 0 while the frame is pinned, indexed by frame id. */
+  std::unique_ptr<std::atomic<uint64_t>[]> stamps_;
+  /** Source of the unpin times, starting at 1. */
+  std::atomic<uint64_t> clock_{0};
+  /** Number of frames with a non-zero stamp. */
+  std::atomic<size_t> size_{0};
+  /** The unpinned frames as of the last time Victim ran out of them, the oldest last. Protected by latch_. */
+  std::vector<std::pair<uint64_t, frame_id_t>> candidates_;
+  /** Serializes victim selection. */
+  std::mutex latch_;
 };
 
 }  // namespace bustub
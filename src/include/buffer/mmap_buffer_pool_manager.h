@@ -0,0 +1,110 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// mmap_buffer_pool_manager.h
+//
+// Identification: src/include/buffer/mmap_buffer_pool_manager.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <memory>
+#include <string>
+
+#include "buffer/buffer_pool_manager.h"
+#include "common/macros.h"
+#include "storage/page/page.h"
+
+namespace bustub {
+
+/**
+ * MmapBufferPoolManager serves the pages of a database file that is only read, e.g. on an analytic replica, straight
+ * from a read-only shared mapping of the file. There are no frames, no page table and no replacement: a fetch returns
+ * a Page whose data points into the mapping, and the operating system's page cache does the caching and read-ahead.
+ *
+ * The pages cannot be modified. The mapping is read-only, so writing to a page faults; unpinning a page dirty, NewPage
+ * and DeletePage are errors. Pin counts and page latches work as usual. The mapping covers the file as it was when
+ * the manager was created; pages appended later are not found.
+ */
+class MmapBufferPoolManager : public BufferPoolManager {
+ public:
+  /**
+   * Map a database file.
+   * @param db_file path of the database file
+   * @throws Exception if the file cannot be opened or mapped
+   */
+  explicit MmapBufferPoolManager(const std::string &db_file);
+
+  /** Unmap the file. */
+  ~MmapBufferPoolManager() override;
+
+  DISALLOW_COPY_AND_MOVE(MmapBufferPoolManager);
+
+  /** @return number of pages in the mapping */
+  size_t GetPoolSize() override { return num_pages_; }
+
+ protected:
+  /**
+   * Pin a page of the mapping.
+   * @param page_id id of page to be fetched
+   * @return the page, nullptr if it is beyond the end of the file
+   */
+  Page *FetchPgImp(page_id_t page_id) override;
+
+  /**
+   * Ask the operating system to read a page of the mapping ahead.
+   * @param page_id id of page to be prefetched
+   */
+  void PrefetchPgImp(page_id_t page_id) override;
+
+  /**
+   * Unpin a page of the mapping.
+   * @param page_id id of page to be unpinned
+   * @param is_dirty must be false, the pages are read-only
+   * @return false if the page pin count is <= 0 before this call, true otherwise
+   */
+  bool UnpinPgImp(page_id_t page_id, bool is_dirty) override;
+
+  /**
+   * Pages of the mapping are never dirty, so there is nothing to flush.
+   * @param page_id id of page to be flushed
+   * @return false if the page is beyond the end of the file, true otherwise
+   */
+  bool FlushPgImp(page_id_t page_id) override;
+
+  /**
+   * The file is read-only: no page can be created.
+   * @param[out] page_id set to INVALID_PAGE_ID
+   * @return nullptr
+   */
+  Page *NewPgImp(page_id_t *page_id) override;
+
+  /**
+   * The file is read-only: no page can be deleted.
+   * @param page_id id of page to be deleted
+   * @return false if the page exists, true if it is beyond the end of the file
+   */
+  bool DeletePgImp(page_id_t page_id) override;
+
+  /** Pages of the mapping are never dirty, so there is nothing to flush. */
+  void FlushAllPgsImp() override {}
+
+ private:
+  /** @return true if page_id is in the mapping */
+  bool IsMapped(page_id_t page_id) const {
+    return page_id >= 0 && static_cast<size_t>(page_id) < num_pages_;
+  }
+
+  /** Start of the mapping, nullptr if the file is empty. */
+  char *base_{nullptr};
+  /** Number of whole pages in the file. A partial page at the end is left out. */
+  size_t num_pages_{0};
+  /** Bookkeeping of every page, whose data_ points into the mapping. */
+  std::unique_ptr<Page[]> pages_;
+};
+
+}  // namespace bustub
@@ -0,0 +1,130 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// page_table.h
+//
+// Identification: src/include/buffer/page_table.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <memory>
+#include <mutex>  // NOLINT
+#include <unordered_map>
+
+#include "common/config.h"
+#include "common/macros.h"
+
+namespace bustub {
+
+/**
+ * PageTable maps resident page ids to the frames that hold them. The table is split into independently latched
+ * shards so that lookups of different pages never contend on a single mutex.
+ *
+ * Callers that need to act on a frame atomically with respect to eviction (e.g. bumping its pin count) pass a
+ * callback that runs while the shard latch is held.
+ */
+class PageTable {
+ public:
+  /**
+   * Creates a new PageTable.
+   * @param num_shards number of shards, rounded up to a power of two
+   */
+  explicit PageTable(size_t num_shards = DEFAULT_NUM_SHARDS);
+
+  ~PageTable() = default;
+
+  DISALLOW_COPY_AND_MOVE(PageTable);
+
+  /**
+   * Look up a page and invoke fn(frame_id) while its shard latch is held.
+   * @param page_id id of the page to look up
+   * @param fn callback invoked with the frame holding the page
+   * @return true if the page was found, false otherwise
+   */
+  template <typename Fn>
+  bool Find(page_id_t page_id, Fn &&fn) {
+    Shard &shard = GetShard(page_id);
+    std::scoped_lock lk{shard.latch_};
+    auto iter = shard.map_.find(page_id);
+    if (iter == shard.map_.end()) {
+      return false;
+    }
+    fn(iter->second);
+    return true;
+  }
+
+  /**
+   * Look up a page.
+   * @param page_id id of the page to look up
+   * @param[out] frame_id frame holding the page
+   * @return true if the page was found, false otherwise
+   */
+  bool Find(page_id_t page_id, frame_id_t *frame_id) {
+    return Find(page_id, [frame_id](frame_id_t frame) { *frame_id = frame; });
+  }
+
+  /**
+   * Insert or overwrite the mapping for a page.
+   * @param page_id id of the page
+   * @param frame_id frame that now holds the page
+   */
+  void Insert(page_id_t page_id, frame_id_t frame_id);
+
+  /**
+   * Remove a page if pred(frame_id) holds, evaluated while the shard latch is held.
+   * @param page_id id of the page to remove
+   * @param pred predicate deciding whether the mapping may be removed
+   * @return true if the page was found and removed
+   */
+  template <typename Pred>
+  bool EraseIf(page_id_t page_id, Pred &&pred) {
+    Shard &shard = GetShard(page_id);
+    std::scoped_lock lk{shard.latch_};
+    auto iter = shard.map_.find(page_id);
+    if (iter == shard.map_.end() || !pred(iter->second)) {
+      return false;
+    }
+    shard.map_.erase(iter);
+    return true;
+  }
+
+  /**
+   * Invoke fn(page_id, frame_id) on every mapping. Each shard is latched while it is visited, so the result is not a
+   * consistent snapshot of the whole table.
+   */
+  template <typename Fn>
+  void ForEach(Fn &&fn) {
+    for (size_t i = 0; i < num_shards_; i++) {
+      std::scoped_lock lk{shards_[i].latch_};
+      for (const auto &[page_id, frame_id] : shards_[i].map_) {
+        fn(page_id, frame_id);
+      }
+    }
+  }
+
+  static constexpr size_t DEFAULT_NUM_SHARDS = 16;
+
+ private:
+  /** Shards are padded to a cache line so that neighbouring latches do not false-share. */
+  struct alignas(64) Shard {
+    std::mutex latch_;
+    std::unordered_map<page_id_t, frame_id_t> map_;
+  };
+
+  /** Page ids of one parallel BPM instance share a residue, so they are scrambled before picking a shard. */
+  Shard &GetShard(page_id_t page_id) {
+    uint64_t hash = static_cast<uint32_t>(static_cast<uint32_t>(page_id) * 0x9E3779B1U);
+    return shards_[hash >> (32 - shard_bits_)];
+  }
+
+  size_t num_shards_;
+  uint32_t shard_bits_;
+  std::unique_ptr<Shard[]> shards_;
+};
+
+}  // namespace bustub
@@ -12,6 +12,10 @@
 
 #pragma once
 
+#include <atomic>
+#include <chrono>  // NOLINT
+#include <mutex>  // NOLINT
+
 #include "buffer/buffer_pool_manager.h"
 #include "recovery/log_manager.h"
 #include "storage/disk/disk_manager.h"
@@ -27,9 +31,10 @@ class ParallelBufferPoolManager : public BufferPoolManager {
    * @param pool_size the pool size of each BufferPoolManagerInstance
    * @param disk_manager the disk manager
    * @param log_manager the log manager (for testing only: nullptr = disable logging)
+   * @param options tunables handed to every BufferPoolManagerInstance
    */
   ParallelBufferPoolManager(size_t num_instances, size_t pool_size, DiskManager *disk_manager,
-                            LogManager *log_manager = nullptr);
+                            LogManager *log_manager = nullptr, const BufferPoolOptions &options = BufferPoolOptions());
 
   /**
    * Destroys an existing ParallelBufferPoolManager.
@@ -39,6 +44,19 @@ class ParallelBufferPoolManager : public BufferPoolManager {
   /** @return size of the buffer pool */
   size_t GetPoolSize() override;
 
+  /**
+   * Resize every BufferPoolManagerInstance, see BufferPoolManagerInstance::Resize. Either every instance gets the new
+   * size or none does: if an instance cannot shrink in time, the instances already shrunk grow back. The number of
+   * instances is fixed: page ids are allocated by instance, so each page belongs to the instance its id maps back to.
+   * @param pool_size the new pool size of each instance
+   * @param timeout how long a shrink waits for pinned pages to be unpinned, in total over all instances
+   * @return false if the pool kept its old size
+   */
+  bool Resize(size_t pool_size, std::chrono::milliseconds timeout = std::chrono::seconds(1));
+
+  /** @return the counters of all instances added up, see BufferPoolManagerInstance::GetStats */
+  BufferPoolStats GetStats();
+
  protected:
   /**
    * @param page_id id of page
@@ -53,6 +71,20 @@ class ParallelBufferPoolManager : public BufferPoolManager {
    */
   Page *FetchPgImp(page_id_t page_id) override;
 
+  /**
+   * Fetch the requested page from the responsible instance, recycling the strategy's ring frames on a miss.
+   * @param page_id id of page to be fetched
+   * @param strategy access strategy of a bulk operation, may be nullptr
+   * @return the requested page
+   */
+  Page *FetchPgStrategyImp(page_id_t page_id, BufferAccessStrategy *strategy) override;
+
+  /**
+   * Schedule a background read of the requested page on the responsible instance.
+   * @param page_id id of page to be prefetched
+   */
+  void PrefetchPgImp(page_id_t page_id) override;
+
   /**
    * Unpin the target page from the buffer pool.
    * @param page_id id of page to be unpinned
@@ -75,6 +107,14 @@ class ParallelBufferPoolManager : public BufferPoolManager {
    */
   Page *NewPgImp(page_id_t *page_id) override;
 
+  /**
+   * Creates a new page in one of the instances, taking its frame from the strategy's ring when possible.
+   * @param[out] page_id id of created page
+   * @param strategy access strategy of a bulk operation, may be nullptr
+   * @return nullptr if no new pages could be created, otherwise pointer to new page
+   */
+  Page *NewPgStrategyImp(page_id_t *page_id, BufferAccessStrategy *strategy) override;
+
   /**
    * Deletes a page from the buffer pool.
    * @param page_id id of page to be deleted
@@ -83,20 +123,32 @@ class ParallelBufferPoolManager : public BufferPoolManager {
   bool DeletePgImp(page_id_t page_id) override;
 
   /**
-   * Flushes all the pages in the buffer pool to disk.
+   * Flushes all the dirty pages of all instances to disk as one checkpoint, so that pages of different instances
+   * with adjacent ids are written together, see BufferPoolManagerInstance::WriteDirtyPages.
    */
   void FlushAllPgsImp() override;
+
+  /** @return a number that identifies the calling thread, handed out in order of the threads' first allocation */
+  static size_t ThreadSlot();
 public:
   // Personal variable
   // the number of instance
   size_t num_ins;
   // the size of each instance
   size_t size_pool;
-  // 
-  size_t next_ins;
+  // the instance the next NewPage starts at, bumped atomically by every NewPage
+  std::atomic<size_t> next_ins;
+  // start NewPage at the calling thread's home instance instead of next_ins
+  bool thread_affinity;
+  // number of NUMA nodes the instances are spread over, instance i lives on node i % numa_nodes (1 if not NUMA-aware)
+  size_t numa_nodes;
   // lock
   size_t latch;
   // the main vector
   std::vector<BufferPoolManagerInstance*> managers_;
+  // the disk manager shared by the instances
+  DiskManager *disk_manager;
+  // serializes Resize, so that size_pool is the size of every instance
+  std::mutex resize_latch;
 };
 }  // namespace bustub
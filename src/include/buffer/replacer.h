@@ -12,10 +12,15 @@
 
 #pragma once
 
+#include <vector>
+
 #include "common/config.h"
 
 namespace bustub {
 
+/** The replacement policies a buffer pool can be configured with. */
+enum class ReplacerType { LRU, CLOCK, LRUK };
+
 /**
  * Replacer is an abstract class that tracks page usage.
  */
@@ -43,6 +48,30 @@ class Replacer {
    */
   virtual void Unpin(frame_id_t frame_id) = 0;
 
+  /**
+   * Tells the replacer which page a frame is being loaded with, before the frame is pinned for it. Replacers that keep
+   * history across evictions use it to recognize a page coming back; the others ignore it.
+   * @param frame_id the id of the frame
+   * @param page_id the id of the page the frame now holds
+   * @param new_page true if the page was just created, so nothing remembered under a reused id applies to it
+   */
+  virtual void SetPage(frame_id_t frame_id, page_id_t page_id, bool new_page) {}
+
+  /**
+   * Forgets a frame whose page is leaving the buffer pool without going through Victim, e.g. a deleted page. The
+   * frame is not victimized until it is unpinned again.
+   * @param frame_id the id of the frame to remove
+   */
+  virtual void Remove(frame_id_t frame_id) { Pin(frame_id); }
+
+  /**
+   * Report the frames that would be victimized next, without removing them. Replacers that cannot predict their
+   * victims report nothing.
+   * @param max_frames the maximum number of frames to report
+   * @param[out] frames receives the frames, the next victim first
+   */
+  virtual void PeekVictims(size_t max_frames, std::vector<frame_id_t> *frames) {}
+
   /** @return the number of elements in the replacer that can be victimized */
   virtual size_t Size() = 0;
 };
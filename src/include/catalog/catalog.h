@@ -217,10 +217,12 @@ class Catalog {
     auto index = std::make_unique<ExtendibleHashTableIndex<KeyType, ValueType, KeyComparator>>(std::move(meta), bpm_,
                                                                                                hash_function);
 
-    // Populate the index with all tuples in table heap
+    // Populate the index with all tuples in table heap. The backfill reads the heap through a ring of frames, so that
+    // it does not evict the working set of concurrent queries.
     auto *table_meta = GetTable(table_name);
     auto *heap = table_meta->table_.get();
-    for (auto tuple = heap->Begin(txn); tuple != heap->End(); ++tuple) {
+    BufferAccessStrategy strategy(AccessStrategyType::BULK_READ);
+    for (auto tuple = heap->Begin(txn, &strategy); tuple != heap->End(); ++tuple) {
       index->InsertEntry(tuple->KeyFromTuple(schema, key_schema, key_attrs), tuple->GetRid(), txn);
     }
 
@@ -13,26 +13,73 @@
 #include <string>
 
 #include "buffer/buffer_pool_manager_instance.h"
+#include "buffer/buffer_pool_options.h"
+#include "buffer/mmap_buffer_pool_manager.h"
+#include "buffer/parallel_buffer_pool_manager.h"
 #include "common/config.h"
+#include "common/macros.h"
 #include "concurrency/lock_manager.h"
 #include "recovery/checkpoint_manager.h"
 #include "recovery/log_manager.h"
 #include "storage/disk/disk_manager.h"
+#include "storage/disk/local_page_cache.h"
 
 namespace bustub {
 
+/**
+ * BustubOptions sizes the components of a BustubInstance at runtime. The defaults build a single buffer pool instance
+ * of BUFFER_POOL_SIZE frames.
+ */
+struct BustubOptions {
+  /** Number of frames of each buffer pool instance. */
+  size_t buffer_pool_size_{BUFFER_POOL_SIZE};
+  /** Number of buffer pool instances. More than one builds a ParallelBufferPoolManager. */
+  size_t buffer_pool_instances_{1};
+  /** Replacement policy and other tunables, handed to every buffer pool instance. */
+  BufferPoolOptions buffer_pool_options_;
+  /** How the disk manager does page I/O, e.g. asynchronously through io_uring. */
+  DiskManagerOptions disk_manager_options_;
+  /** Pages of the second-tier page cache on local storage, see LocalPageCache. 0 runs without one. */
+  size_t local_cache_pages_{0};
+  /** File of the second-tier page cache, on a fast local device. */
+  std::string local_cache_file_{"bustub_local_cache.tmp"};
+  /** Clean evictions of a page before the second-tier page cache admits it. */
+  size_t local_cache_admission_threshold_{2};
+  /**
+   * Serve pages from a read-only mapping of the database file instead of a buffer pool, see MmapBufferPoolManager.
+   * For read-only replicas: the buffer pool options are ignored, and pages cannot be created or modified.
+   */
+  bool read_only_mmap_{false};
+};
+
 class BustubInstance {
  public:
-  explicit BustubInstance(const std::string &db_file_name) {
+  explicit BustubInstance(const std::string &db_file_name, const BustubOptions &options = BustubOptions()) {
+    BUSTUB_ASSERT(options.buffer_pool_size_ > 0, "the buffer pool needs at least one frame");
+    BUSTUB_ASSERT(options.buffer_pool_instances_ > 0, "the buffer pool needs at least one instance");
     enable_logging = false;
 
     // storage related
-    disk_manager_ = new DiskManager(db_file_name);
+    disk_manager_ = new DiskManager(db_file_name, options.disk_manager_options_);
+    if (options.local_cache_pages_ > 0) {
+      local_page_cache_ = new LocalPageCache(options.local_cache_file_, options.local_cache_pages_,
+                                             options.local_cache_admission_threshold_);
+      disk_manager_->SetPageCache(local_page_cache_);
+    }
 
     // log related
     log_manager_ = new LogManager(disk_manager_);
 
-    buffer_pool_manager_ = new BufferPoolManagerInstance(BUFFER_POOL_SIZE, disk_manager_, log_manager_);
+    if (options.read_only_mmap_) {
+      buffer_pool_manager_ = new MmapBufferPoolManager(db_file_name);
+    } else if (options.buffer_pool_instances_ > 1) {
+      buffer_pool_manager_ =
+          new ParallelBufferPoolManager(options.buffer_pool_instances_, options.buffer_pool_size_, disk_manager_,
+                                        log_manager_, options.buffer_pool_options_);
+    } else {
+      buffer_pool_manager_ = new BufferPoolManagerInstance(options.buffer_pool_size_, disk_manager_, log_manager_,
+                                                           options.buffer_pool_options_);
+    }
 
     // txn related
     lock_manager_ = new LockManager();
@@ -52,9 +99,11 @@ class BustubInstance {
     delete lock_manager_;
     delete transaction_manager_;
     delete disk_manager_;
+    delete local_page_cache_;
   }
 
   DiskManager *disk_manager_;
+  LocalPageCache *local_page_cache_{nullptr};
   BufferPoolManager *buffer_pool_manager_;
   LockManager *lock_manager_;
   TransactionManager *transaction_manager_;
@@ -12,25 +12,25 @@
 
 #pragma once
 
-#include <climits>
-#include <condition_variable>  // NOLINT
-#include <mutex>               // NOLINT
+#include <atomic>
+#include <cstdint>
 
 #include "common/macros.h"
 
 namespace bustub {
 
 /**
- * Reader-Writer latch backed by std::mutex.
+ * Reader-Writer latch packed into a single 32-bit atomic word, so that every Page can embed one cheaply.
+ *
+ * Uncontended RLock/RUnlock/WLock/WUnlock are a single atomic read-modify-write. A thread that cannot get the latch
+ * spins for a short while and then parks on the word (a futex on Linux, yielding elsewhere) until an unlock wakes it.
+ *
+ * The latch prefers writers: once a writer is waiting, new readers queue up behind it instead of starving it.
  */
 class ReaderWriterLatch {
-  using mutex_t = std::mutex;
-  using cond_t = std::condition_variable;
-  static const uint32_t MAX_READERS = UINT_MAX;
-
  public:
   ReaderWriterLatch() = default;
-  ~ReaderWriterLatch() { std::lock_guard<mutex_t> guard(mutex_); }
+  ~ReaderWriterLatch() = default;
 
   DISALLOW_COPY(ReaderWriterLatch);
 
@@ -38,13 +38,9 @@ class ReaderWriterLatch {
    * Acquire a write latch.
    */
   void WLock() {
-    std::unique_lock<mutex_t> latch(mutex_);
-    while (writer_entered_) {
-      reader_.wait(latch);
-    }
-    writer_entered_ = true;
-    while (reader_count_ > 0) {
-      writer_.wait(latch);
+    uint32_t expected = 0;
+    if (!state_.compare_exchange_strong(expected, WRITER, std::memory_order_acquire, std::memory_order_relaxed)) {
+      WLockSlow();
     }
   }
 
@@ -52,45 +48,79 @@ class ReaderWriterLatch {
    * Release a write latch.
    */
   void WUnlock() {
-    std::lock_guard<mutex_t> guard(mutex_);
-    writer_entered_ = false;
-    reader_.notify_all();
+    uint32_t prev = state_.fetch_and(~(WRITER | PARKED), std::memory_order_release);
+    if ((prev & PARKED) != 0) {
+      WakeAll();
+    }
   }
 
   /**
    * Acquire a read latch.
    */
   void RLock() {
-    std::unique_lock<mutex_t> latch(mutex_);
-    while (writer_entered_ || reader_count_ == MAX_READERS) {
-      reader_.wait(latch);
+    uint32_t state = state_.load(std::memory_order_relaxed);
+    if ((state & (WRITER | WAITING_WRITERS_MASK)) != 0 || (state & READERS_MASK) == MAX_READERS ||
+        !state_.compare_exchange_weak(state, state + 1, std::memory_order_acquire, std::memory_order_relaxed)) {
+      RLockSlow();
+    }
+  }
+
+  /**
+   * Acquire a read latch if that does not require waiting.
+   * @return true if the read latch was acquired
+   */
+  bool TryRLock() {
+    uint32_t state = state_.load(std::memory_order_relaxed);
+    while ((state & (WRITER | WAITING_WRITERS_MASK)) == 0 && (state & READERS_MASK) != MAX_READERS) {
+      if (state_.compare_exchange_weak(state, state + 1, std::memory_order_acquire, std::memory_order_relaxed)) {
+        return true;
+      }
     }
-    reader_count_++;
+    return false;
   }
 
   /**
    * Release a read latch.
    */
   void RUnlock() {
-    std::lock_guard<mutex_t> guard(mutex_);
-    reader_count_--;
-    if (writer_entered_) {
-      if (reader_count_ == 0) {
-        writer_.notify_one();
-      }
-    } else {
-      if (reader_count_ == MAX_READERS - 1) {
-        reader_.notify_one();
-      }
+    uint32_t prev = state_.fetch_sub(1, std::memory_order_release);
+    // Only the last reader can let a writer in, only a reader leaving a full latch can let a reader in.
+    if ((prev & PARKED) != 0 && ((prev & READERS_MASK) == 1 || (prev & READERS_MASK) == MAX_READERS)) {
+      state_.fetch_and(~PARKED, std::memory_order_relaxed);
+      WakeAll();
     }
   }
 
  private:
-  mutex_t mutex_;
-  cond_t writer_;
-  cond_t reader_;
-  uint32_t reader_count_{0};
-  bool writer_entered_{false};
+  /** Set while a writer holds the latch. */
+  static constexpr uint32_t WRITER = 1U << 31;
+  /** Set while some thread is (about to be) parked on state_ and must be woken by the next unlock. */
+  static constexpr uint32_t PARKED = 1U << 30;
+  /** Number of writers waiting for the latch, in bits 20..29. New readers wait while it is non-zero. */
+  static constexpr uint32_t WAITING_WRITER = 1U << 20;
+  static constexpr uint32_t WAITING_WRITERS_MASK = PARKED - WAITING_WRITER;
+  /** Number of readers holding the latch, in bits 0..19. */
+  static constexpr uint32_t READERS_MASK = WAITING_WRITER - 1;
+  static constexpr uint32_t MAX_READERS = READERS_MASK;
+  /** Attempts a waiting thread spins for before it parks. */
+  static constexpr int SPIN_LIMIT = 64;
+
+  void WLockSlow();
+  void RLockSlow();
+
+  /**
+   * Spin once, or park until state_ changes from state if the thread has spun for long enough.
+   * @param state the state that kept the caller from getting the latch
+   * @param spins number of times the caller has waited so far, incremented here
+   */
+  void Wait(uint32_t state, int *spins);
+
+  /** Wake all threads parked on state_. */
+  void WakeAll();
+
+  std::atomic<uint32_t> state_{0};
 };
 
+static_assert(sizeof(ReaderWriterLatch) <= 8, "ReaderWriterLatch is embedded in every Page and must stay small");
+
 }  // namespace bustub
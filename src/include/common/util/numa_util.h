@@ -0,0 +1,47 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// numa_util.h
+//
+// Identification: src/include/common/util/numa_util.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstddef>
+
+namespace bustub {
+
+/**
+ * NumaUtil wraps the few libnuma calls the buffer pool needs. When BusTub is built without libnuma, or the machine
+ * does not support NUMA, it behaves as if there was a single node 0 and binding memory does nothing.
+ */
+class NumaUtil {
+ public:
+  /** @return true if memory can actually be bound to nodes */
+  static bool IsAvailable();
+
+  /** @return number of NUMA nodes, at least 1 */
+  static int NumNodes();
+
+  /** @return the node of the CPU the calling thread runs on */
+  static int CurrentNode();
+
+  /**
+   * Place the memory [addr, addr + length) on a node. Pages that are already backed by memory are not moved, so this
+   * should be called before the memory is first touched.
+   */
+  static void BindMemory(void *addr, size_t length, int node);
+
+  /**
+   * Restrict the calling thread to the CPUs of a node, or let it run anywhere again if node is -1.
+   * @return false if the thread could not be moved
+   */
+  static bool RunOnNode(int node);
+};
+
+}  // namespace bustub
@@ -0,0 +1,50 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// page_codec.h
+//
+// Identification: src/include/common/util/page_codec.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstddef>
+
+namespace bustub {
+
+/**
+ * PageCodec compresses single pages. It uses LZ4 when BusTub is built with liblz4, and otherwise a small built-in
+ * LZ77 codec that is good at the long runs of zeroes in partially filled pages.
+ */
+class PageCodec {
+ public:
+  /** @return the name of the codec in use, "lz4" or "builtin" */
+  static const char *Name();
+
+  /** @return the size of an output buffer that is large enough for Compress to fail only on incompressible data */
+  static size_t MaxCompressedSize();
+
+  /**
+   * Compress a page.
+   * @param page PAGE_SIZE bytes of page data
+   * @param[out] out output buffer
+   * @param capacity size of out
+   * @return the compressed size, 0 if it does not fit in capacity
+   */
+  static size_t Compress(const char *page, char *out, size_t capacity);
+
+  /**
+   * Decompress a page.
+   * @param in compressed data
+   * @param size the compressed size Compress returned
+   * @param[out] page PAGE_SIZE bytes of output
+   * @return false if the data is corrupt
+   */
+  static bool Decompress(const char *in, size_t size, char *page);
+};
+
+}  // namespace bustub
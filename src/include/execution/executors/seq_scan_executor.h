@@ -12,17 +12,23 @@
 
 #pragma once
 
+#include <memory>
+#include <optional>
 #include <vector>
 
+#include "buffer/buffer_access_strategy.h"
+#include "catalog/catalog.h"
 #include "execution/executor_context.h"
 #include "execution/executors/abstract_executor.h"
 #include "execution/plans/seq_scan_plan.h"
+#include "storage/table/table_iterator.h"
 #include "storage/table/tuple.h"
 
 namespace bustub {
 
 /**
- * The SeqScanExecutor executor executes a sequential table scan.
+ * The SeqScanExecutor executor executes a sequential table scan. The table is read through a BULK_READ access
+ * strategy, so scanning a large table does not flush the rest of the buffer pool.
  */
 class SeqScanExecutor : public AbstractExecutor {
  public:
@@ -50,5 +56,11 @@ class SeqScanExecutor : public AbstractExecutor {
  private:
   /** The sequential scan plan node to be executed */
   const SeqScanPlanNode *plan_;
+  /** The table being scanned */
+  const TableInfo *table_info_;
+  /** Ring of frames the scan reads the table through */
+  std::unique_ptr<BufferAccessStrategy> strategy_;
+  /** Position of the scan, set by Init */
+  std::optional<TableIterator> iter_;
 };
 }  // namespace bustub
@@ -0,0 +1,144 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// async_disk_io.h
+//
+// Identification: src/include/storage/disk/async_disk_io.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <sys/uio.h>
+
+#include <condition_variable>  // NOLINT
+#include <cstdint>
+#include <deque>
+#include <future>  // NOLINT
+#include <mutex>  // NOLINT
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "common/config.h"
+#include "common/macros.h"
+
+namespace bustub {
+
+/** A page read or write handed to AsyncDiskIo::Submit. */
+struct DiskRequest {
+  /** True for a write, false for a read. */
+  bool is_write_{false};
+  /** Page to read or write. */
+  page_id_t page_id_{INVALID_PAGE_ID};
+  /** PAGE_SIZE bytes: the destination of a read, the source of a write. Must stay valid until completion. */
+  char *data_{nullptr};
+  /** Fulfilled with true once the page is read or written, with false on an I/O error. */
+  std::promise<bool> callback_;
+};
+
+/**
+ * AsyncDiskIo keeps many page reads and writes of a file in flight at once. It submits them to an io_uring when the
+ * kernel supports it, and otherwise runs them as pread/pwrite on a pool of threads. Either way the caller submits
+ * requests, goes on, and collects each completion from the future of its request's callback_.
+ *
+ * Reads past the end of the file complete successfully with the missing part of the page zeroed.
+ */
+class AsyncDiskIo {
+ public:
+  /**
+   * Start serving a file.
+   * @param fd descriptor of the file, opened for reading and writing; not owned
+   * @param queue_depth most requests in flight at once
+   * @param num_threads threads doing the I/O when io_uring is not used
+   * @param use_io_uring try io_uring first; false always uses the thread pool
+   */
+  AsyncDiskIo(int fd, size_t queue_depth, size_t num_threads, bool use_io_uring = true);
+
+  /** Wait for the requests in flight, then stop. */
+  ~AsyncDiskIo();
+
+  DISALLOW_COPY_AND_MOVE(AsyncDiskIo);
+
+  /** Queue a request. Blocks while queue_depth requests are in flight. */
+  void Submit(DiskRequest request);
+
+  /** Queue several requests. With io_uring they share one system call. */
+  void Submit(std::vector<DiskRequest> *requests);
+
+  /** @return true if the requests go through io_uring, false if they run on the thread pool */
+  bool UsesIoUring() const { return ring_fd_ >= 0; }
+
+ private:
+  /** A request in flight through the ring. The slot index is the request's user_data and SQE index. */
+  struct Slot {
+    DiskRequest request_;
+    struct iovec iov_;
+  };
+
+  /** Map the rings of io_uring. @return false if the kernel does not support io_uring */
+  bool SetUpRing(size_t queue_depth);
+
+  /** Unmap the rings and close the io_uring descriptor, whatever part of them SetUpRing got to. */
+  void TearDownRing(int ring_fd);
+
+  /** Hand to_submit new entries of the submission ring to the kernel. The caller must hold ring_latch_. */
+  void EnterRing(unsigned to_submit);
+
+  /** Put requests into the submission ring and enter the kernel. */
+  void SubmitToRing(std::vector<DiskRequest> *requests);
+
+  /** Body of the thread reaping the completion ring. */
+  void CompletionThreadMain();
+
+  /** Body of the threads of the fallback pool. */
+  void WorkerThreadMain();
+
+  /**
+   * Finish a request whose first done bytes were transferred, doing the rest with pread/pwrite, and fulfill its
+   * callback_.
+   */
+  void Complete(DiskRequest *request, int64_t done);
+
+  const int fd_;
+
+  /** io_uring descriptor, -1 if the thread pool is used. */
+  int ring_fd_{-1};
+  void *sq_ring_{nullptr};
+  size_t sq_ring_size_{0};
+  void *cq_ring_{nullptr};
+  size_t cq_ring_size_{0};
+  void *sqes_{nullptr};
+  size_t sqes_size_{0};
+  /** Pointers into the mapped rings. */
+  unsigned *sq_tail_{nullptr};
+  unsigned *sq_mask_{nullptr};
+  unsigned *sq_array_{nullptr};
+  unsigned *cq_head_{nullptr};
+  unsigned *cq_tail_{nullptr};
+  unsigned *cq_mask_{nullptr};
+  void *cqes_{nullptr};
+  /** Protects slots_ and free_slots_ and serializes submissions. */
+  std::mutex ring_latch_;
+  /** Signalled when a slot is freed. */
+  std::condition_variable slot_cv_;
+  std::vector<Slot> slots_;
+  std::vector<unsigned> free_slots_;
+  std::thread completion_thread_;
+
+  /** Requests waiting for the fallback threads, at most queue_depth_ of them. */
+  std::deque<DiskRequest> queue_;
+  const size_t queue_depth_;
+  /** Protects queue_ and stop_. */
+  std::mutex queue_latch_;
+  /** Signalled when a request is queued or stop_ is set. */
+  std::condition_variable queue_cv_;
+  /** Signalled when a request leaves queue_. */
+  std::condition_variable space_cv_;
+  bool stop_{false};
+  std::vector<std::thread> workers_;
+};
+
+}  // namespace bustub
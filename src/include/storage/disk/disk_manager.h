@@ -13,15 +13,40 @@
 #pragma once
 
 #include <atomic>
+#include <cstdint>
 #include <fstream>
 #include <future>  // NOLINT
-#include <mutex>   // NOLINT
+#include <memory>
+#include <mutex>  // NOLINT
+#include <set>
 #include <string>
+#include <vector>
 
 #include "common/config.h"
+#include "storage/disk/async_disk_io.h"
+#include "storage/disk/local_page_cache.h"
 
 namespace bustub {
 
+/** DiskManagerOptions selects how a DiskManager does page I/O. The defaults do synchronous pread/pwrite on db_fd_. */
+struct DiskManagerOptions {
+  /** Do page reads and writes through AsyncDiskIo, so that many of them can be in flight at once. */
+  bool async_io_{false};
+  /** With async_io_, most page requests in flight at once. */
+  size_t io_queue_depth_{64};
+  /** With async_io_, threads doing the I/O when io_uring is not available. */
+  size_t io_threads_{4};
+  /** With async_io_, try io_uring before the thread pool. */
+  bool io_uring_{true};
+  /**
+   * Open the database file with O_DIRECT, so that pages are cached once, in the buffer pool, and not again in the
+   * operating system's page cache. Buffers aligned to DiskManager::DIRECT_IO_ALIGNMENT, like the frames of the buffer
+   * pool, are used as is; others go through a bounce buffer. Falls back to buffered I/O on filesystems that reject
+   * direct I/O.
+   */
+  bool direct_io_{false};
+};
+
 /**
  * DiskManager takes care of the allocation and deallocation of pages within a database. It performs the reading and
  * writing of pages to and from disk, providing a logical file layer within the context of a database management system.
@@ -31,10 +56,12 @@ class DiskManager {
   /**
    * Creates a new disk manager that writes to the specified database file.
    * @param db_file the file name of the database file to write to
+   * @param options how to do page I/O
    */
-  explicit DiskManager(const std::string &db_file);
+  explicit DiskManager(const std::string &db_file, const DiskManagerOptions &options = DiskManagerOptions());
 
-  ~DiskManager() = default;
+  /** Closes the database file, if ShutDown did not. */
+  ~DiskManager();
 
   /**
    * Shut down the disk manager and close all the file resources.
@@ -42,19 +69,73 @@ class DiskManager {
   void ShutDown();
 
   /**
-   * Write a page to the database file.
+   * Write a page to the database file. Writes and reads of different pages may run concurrently.
    * @param page_id id of the page
    * @param page_data raw page data
    */
   void WritePage(page_id_t page_id, const char *page_data);
 
   /**
-   * Read a page from the database file.
+   * Read a page from the database file. Reads of different pages run in parallel.
    * @param page_id id of the page
    * @param[out] page_data output buffer
    */
   void ReadPage(page_id_t page_id, char *page_data);
 
+  /**
+   * Start reading a page. Without async_io_ the read is done before returning.
+   * @param page_id id of the page
+   * @param[out] page_data output buffer, must stay valid until the future is ready
+   * @return a future that becomes true once the page is read, false on an I/O error
+   */
+  std::future<bool> ReadPageAsync(page_id_t page_id, char *page_data);
+
+  /**
+   * Start writing a page. Without async_io_ the write is done before returning.
+   * @param page_id id of the page
+   * @param page_data raw page data, must stay valid until the future is ready
+   * @return a future that becomes true once the page is written, false on an I/O error
+   */
+  std::future<bool> WritePageAsync(page_id_t page_id, const char *page_data);
+
+  /**
+   * Start a batch of page reads and writes; with io_uring they are submitted in one system call. Each request's
+   * callback_ tells when it is done.
+   * @param requests the requests, moved from
+   */
+  void SubmitRequests(std::vector<DiskRequest> *requests);
+
+  /** @return true if ReadPage and WritePage go through AsyncDiskIo */
+  bool IsAsync() const { return async_io_ != nullptr; }
+
+  /** @return true if the database file is open with O_DIRECT */
+  bool IsDirectIo() const { return direct_io_; }
+
+  /** Alignment of buffers, offsets and sizes that O_DIRECT requires. */
+  static constexpr size_t DIRECT_IO_ALIGNMENT = 4096;
+
+  /**
+   * Write a run of pages with consecutive ids to the database file in one write. Unlike WritePage the data is only
+   * handed to the operating system; call Sync to make it durable.
+   * @param first_page_id id of the first page of the run
+   * @param pages_data num_pages * PAGE_SIZE bytes, the pages back to back
+   * @param num_pages number of pages in the run
+   */
+  void WritePages(page_id_t first_page_id, const char *pages_data, size_t num_pages);
+
+  /** Flush everything written to the database file so far to stable storage. */
+  void Sync();
+
+  /**
+   * Put a second-tier page cache in front of the database file: ReadPage looks pages up in it first, and WritePage
+   * invalidates the cached copy. The buffer pool offers it the clean pages it evicts.
+   * @param cache the cache, not owned; nullptr removes it
+   */
+  void SetPageCache(LocalPageCache *cache) { page_cache_ = cache; }
+
+  /** @return the second-tier page cache, nullptr if there is none */
+  LocalPageCache *GetPageCache() const { return page_cache_; }
+
   /**
    * Flush the entire log buffer into disk.
    * @param log_data raw log data
@@ -80,6 +161,44 @@ class DiskManager {
   /** @return the number of disk writes */
   int GetNumWrites() const;
 
+  /** @return the size of the database file in bytes, as far as pages were written through this disk manager */
+  int64_t GetDbFileSize() const { return db_file_size_.load(); }
+
+  /**
+   * Set how page ids are striped over buffer pool instances: instance i allocates the ids with id % num_instances == i,
+   * and AllocateFreePage hands it only freed pages of its own stripe.
+   * @param num_instances number of buffer pool instances sharing the database file
+   */
+  void SetNumInstances(uint32_t num_instances);
+
+  /**
+   * Record that a page is no longer used, so that AllocateFreePage can hand out its id again. The free pages are kept
+   * in a file next to the database file (".fsm" instead of its extension), written by Sync and ShutDown.
+   * @param page_id id of the page
+   */
+  void DeallocatePage(page_id_t page_id);
+
+  /**
+   * Take a freed page of an instance's stripe for reuse, the lowest id first. Before handing out an id, the lowest
+   * batch of the stripe's freed pages is reserved: they are removed from the free page file, which is rewritten and
+   * synced once per batch, so that a crash cannot hand a page out twice. A crash leaks the reserved pages that were
+   * not handed out yet; ShutDown puts them back in the file.
+   * @param instance_index index of the buffer pool instance
+   * @return the page id, INVALID_PAGE_ID if the stripe has no freed pages
+   */
+  page_id_t AllocateFreePage(uint32_t instance_index);
+
+  /** @return the number of freed pages waiting to be reused */
+  size_t GetNumFreePages();
+
+  /**
+   * Shrink the database file by the freed pages at its end. Their ids leave the free list; they are handed out again
+   * once allocation reaches the end of the file, e.g. by the buffer pool of the next run. Must not run concurrently with
+   * page writes, e.g. call it after flushing the buffer pool.
+   * @return the number of pages released
+   */
+  size_t TruncateFreePages();
+
   /**
    * Sets the future which is used to check for non-blocking flushes.
    * @param f the non-blocking flush check
@@ -90,19 +209,56 @@ class DiskManager {
   inline bool HasFlushLogFuture() { return flush_log_f_ != nullptr; }
 
  private:
-  int GetFileSize(const std::string &file_name);
+  int64_t GetFileSize(const std::string &file_name);
+  /** Record that the database file now reaches at least end bytes. */
+  void ExtendDbFileSize(int64_t end);
+  /** Read the free page file, dropping pages that are not in the database file. */
+  void LoadFreePages();
+  /**
+   * Write the free page file if the free pages changed since it was last written.
+   * @param release_reserved whether to put the pages reserved by AllocateFreePage back on the free list first
+   */
+  void SaveFreePages(bool release_reserved = false);
+  /**
+   * Write the free page file and sync it, removing it if there are no free pages. The caller holds free_pages_latch_.
+   * @return false on an I/O error
+   */
+  bool WriteFreePages();
+  /** Read a page from the database file itself, bypassing the page cache and AsyncDiskIo. */
+  void ReadPageFromFile(page_id_t page_id, char *page_data);
+  /** @return true if direct I/O can use data as is */
+  bool IsAligned(const char *data) const {
+    return !direct_io_ || reinterpret_cast<uintptr_t>(data) % DIRECT_IO_ALIGNMENT == 0;
+  }
   // stream to write log file
   std::fstream log_io_;
   std::string log_name_;
-  // stream to write db file
-  std::fstream db_io_;
+  // descriptor of the db file; pages are read and written with pread/pwrite, which share no cursor
+  int db_fd_{-1};
+  // true if db_fd_ is open with O_DIRECT
+  bool direct_io_{false};
+  // size of the db file, tracked in memory so that reads need not stat() it
+  std::atomic<int64_t> db_file_size_{0};
+  // file that keeps the free pages between runs
+  std::string fsm_name_;
+  // freed pages by stripe, free_pages_[page_id % free_pages_.size()]
+  std::vector<std::set<page_id_t>> free_pages_{1};
+  // freed pages taken out of the free page file by AllocateFreePage but not handed out yet, striped like free_pages_
+  std::vector<std::set<page_id_t>> reserved_pages_{1};
+  // true if free_pages_ changed since the free page file was written
+  bool free_pages_dirty_{false};
+  std::mutex free_pages_latch_;
   std::string file_name_;
   int num_flushes_;
-  int num_writes_;
+  std::atomic<int> num_writes_;
   bool flush_log_;
   std::future<void> *flush_log_f_;
-  // With multiple buffer pool instances, need to protect file access
+  // protects closing db_fd_ in ShutDown; page I/O does not take it
   std::mutex db_io_latch_;
+  // second-tier page cache on local storage, may be nullptr
+  LocalPageCache *page_cache_{nullptr};
+  // asynchronous page I/O on db_fd_, nullptr unless DiskManagerOptions::async_io_
+  std::unique_ptr<AsyncDiskIo> async_io_;
 };
 
 }  // namespace bustub
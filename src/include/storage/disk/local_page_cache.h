@@ -0,0 +1,147 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// local_page_cache.h
+//
+// Identification: src/include/storage/disk/local_page_cache.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <list>
+#include <mutex>  // NOLINT
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "common/config.h"
+#include "common/macros.h"
+
+namespace bustub {
+
+/**
+ * LocalPageCache is a second-tier page cache kept in a file on fast local storage, for databases whose file lives on
+ * a slower (e.g. network-attached) volume. It sits behind the buffer pool: clean pages the buffer pool evicts are
+ * offered to it, and DiskManager::ReadPage looks a page up here before reading the database file.
+ *
+ * The cache only ever holds pages identical to their copy in the database file. DiskManager::WritePage invalidates
+ * the cached copy, and an admission that raced with such a write is dropped, see BeginAdmit. The cache file is
+ * scratch space: it is truncated when the cache is created and removed when it is destroyed.
+ *
+ * Admission policy: a page is only admitted on its admission_threshold-th clean eviction among the recently evicted
+ * pages, so that pages read once by a scan do not push out pages that keep coming back. Slots are replaced in CLOCK
+ * order.
+ */
+class LocalPageCache {
+ public:
+  /**
+   * Creates a cache of capacity pages in cache_file.
+   * @param cache_file path of the cache file, on local storage
+   * @param capacity number of pages the cache holds
+   * @param admission_threshold number of clean evictions of a page before it is admitted, 1 admits every page
+   */
+  LocalPageCache(const std::string &cache_file, size_t capacity, size_t admission_threshold = 2);
+
+  ~LocalPageCache();
+
+  DISALLOW_COPY_AND_MOVE(LocalPageCache);
+
+  /**
+   * Read a page from the cache.
+   * @param page_id id of the page
+   * @param[out] page_data output buffer, unspecified on a miss
+   * @return true if the page was cached
+   */
+  bool ReadPage(page_id_t page_id, char *page_data);
+
+  /**
+   * Start offering a clean page that the buffer pool is evicting. Call it while the page is still in the buffer pool
+   * (under its latch), and FinishAdmit once its data can be copied.
+   * @param page_id id of the evicted page
+   * @return a ticket for FinishAdmit, 0 if the admission policy rejects the page or it is already cached
+   */
+  uint64_t BeginAdmit(page_id_t page_id);
+
+  /**
+   * Copy an evicted page into the cache, unless the page was invalidated since BeginAdmit.
+   * @param page_id id of the evicted page
+   * @param page_data content of the page, identical to the database file
+   * @param ticket what BeginAdmit returned, 0 does nothing
+   */
+  void FinishAdmit(page_id_t page_id, const char *page_data, uint64_t ticket);
+
+  /** Drop the cached copy of a page, because the page is being written or deleted. */
+  void Invalidate(page_id_t page_id);
+
+  /** @return number of pages the cache holds at most */
+  size_t GetCapacity() const { return slots_.size(); }
+
+  /** @return number of ReadPage calls that found their page */
+  uint64_t GetHits() const { return hits_; }
+
+  /** @return number of ReadPage calls that did not find their page */
+  uint64_t GetMisses() const { return misses_; }
+
+  /** @return number of pages copied into the cache */
+  uint64_t GetAdmissions() const { return admissions_; }
+
+ private:
+  /** Number of invalidation counters tickets are checked against. Pages share counters modulo this. */
+  static constexpr size_t NUM_EPOCHS = 1024;
+
+  struct Slot {
+    /** Page the slot holds, INVALID_PAGE_ID while it is empty or being filled. */
+    page_id_t page_id_{INVALID_PAGE_ID};
+    /**
+     * Bumped whenever the slot stops holding its page, so that a concurrent ReadPage can tell. Odd while the slot is
+     * being filled by FinishAdmit.
+     */
+    uint64_t version_{0};
+    /** CLOCK reference bit. */
+    bool referenced_{false};
+  };
+
+  /** @return the invalidation counter of page_id */
+  std::atomic<uint64_t> &Epoch(page_id_t page_id) { return epochs_[static_cast<size_t>(page_id) % NUM_EPOCHS]; }
+
+  /** Empty the slot holding page_id, if any. The caller must hold latch_. */
+  void EvictLocked(page_id_t page_id);
+
+  /** @return true if the admission policy lets page_id in on this eviction. The caller must hold latch_. */
+  bool ShouldAdmit(page_id_t page_id);
+
+  /** @return a slot to fill, taking it away from its page if it had one. The caller must hold latch_. */
+  size_t PickSlot();
+
+  std::string file_name_;
+  int fd_{-1};
+  const size_t admission_threshold_;
+
+  /** Protects everything below except the counters. */
+  std::mutex latch_;
+  std::vector<Slot> slots_;
+  std::unordered_map<page_id_t, size_t> page_slots_;
+  size_t clock_hand_{0};
+  /** Number of evictions of a page that was not admitted yet, and its position in eviction_history_. */
+  struct EvictionCount {
+    size_t count_;
+    std::list<page_id_t>::iterator history_;
+  };
+  /** Recently evicted pages that were not admitted yet, oldest first; each page is listed once. */
+  std::unordered_map<page_id_t, EvictionCount> eviction_counts_;
+  std::list<page_id_t> eviction_history_;
+
+  std::array<std::atomic<uint64_t>, NUM_EPOCHS> epochs_{};
+  std::atomic<uint64_t> hits_{0};
+  std::atomic<uint64_t> misses_{0};
+  std::atomic<uint64_t> admissions_{0};
+};
+
+}  // namespace bustub
@@ -12,6 +12,7 @@
 
 #pragma once
 
+#include <atomic>
 #include <cstring>
 #include <iostream>
 
@@ -24,14 +25,23 @@ namespace bustub {
  * Page is the basic unit of storage within the database system. Page provides a wrapper for actual data pages being
  * held in main memory. Page also contains book-keeping information that is used by the buffer pool manager, e.g.
  * pin count, dirty flag, page id, etc.
+ *
+ * The data itself is not part of the Page: the buffer pool points each Page at a frame of its FrameArena, so that the
+ * array of Pages stays compact and the frames are aligned for direct I/O.
+ *
+ * Besides the reader-writer latch, a page supports optimistic reads: every WLatch/WUnlatch pair bumps a version
+ * counter, so a reader can snapshot the version, read the page without latching it, and validate afterwards that no
+ * writer got in between. A validated read writes nothing to shared memory, which keeps hot, rarely written pages (e.g.
+ * the upper levels of an index) from bouncing their latch's cache line between cores.
  */
 class Page {
   // There is book-keeping information inside the page that should only be relevant to the buffer pool manager.
   friend class BufferPoolManagerInstance;
+  friend class MmapBufferPoolManager;
 
  public:
-  /** Constructor. Zeros out the page data. */
-  Page() { ResetMemory(); }
+  /** Constructor. The page has no data until the buffer pool assigns it a frame. */
+  Page() = default;
 
   /** Default destructor. */
   ~Page() = default;
@@ -48,24 +58,77 @@ class Page {
   /** @return true if the page in memory has been modified from the page on disk, false otherwise */
   inline bool IsDirty() { return is_dirty_; }
 
-  /** Acquire the page write latch. */
-  inline void WLatch() { rwlatch_.WLock(); }
+  /** Acquire the page write latch. Makes the page version odd, failing concurrent optimistic reads. */
+  inline void WLatch() {
+    rwlatch_.WLock();
+    version_.store(version_.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+  }
 
-  /** Release the page write latch. */
-  inline void WUnlatch() { rwlatch_.WUnlock(); }
+  /** Release the page write latch. Makes the page version even again. */
+  inline void WUnlatch() {
+    version_.store(version_.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    rwlatch_.WUnlock();
+  }
 
   /** Acquire the page read latch. */
   inline void RLatch() { rwlatch_.RLock(); }
 
+  /** Acquire the page read latch if no writer holds or waits for it. @return true if the latch was acquired */
+  inline bool TryRLatch() { return rwlatch_.TryRLock(); }
+
   /** Release the page read latch. */
   inline void RUnlatch() { rwlatch_.RUnlock(); }
 
+  /**
+   * Start an optimistic read. The caller must keep the page pinned, read it without latching it, and must not act on
+   * what it read (e.g. follow a page id) before ValidateOptimisticRead succeeds.
+   * @return the version to validate against, odd if a writer holds the latch (validation will fail)
+   */
+  inline uint64_t OptimisticReadBegin() { return version_.load(std::memory_order_acquire); }
+
+  /**
+   * Finish an optimistic read.
+   * @param version what OptimisticReadBegin returned
+   * @return true if the page was not write latched at any point since OptimisticReadBegin, i.e. the read is consistent
+   */
+  inline bool ValidateOptimisticRead(uint64_t version) {
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return (version & 1) == 0 && version_.load(std::memory_order_relaxed) == version;
+  }
+
+  /**
+   * Run read_fn() as an optimistic read, retrying a few times if a writer interferes and falling back to the read
+   * latch after that. read_fn may run several times and must only collect values.
+   * @return the result of the run of read_fn that was consistent
+   */
+  template <typename ReadFn>
+  inline auto ReadOptimistically(ReadFn &&read_fn) {
+    for (int attempt = 0; attempt < MAX_OPTIMISTIC_ATTEMPTS; attempt++) {
+      uint64_t version = OptimisticReadBegin();
+      if ((version & 1) != 0) {
+        continue;
+      }
+      auto result = read_fn();
+      if (ValidateOptimisticRead(version)) {
+        return result;
+      }
+    }
+    RLatch();
+    auto result = read_fn();
+    RUnlatch();
+    return result;
+  }
+
   /** @return the page LSN. */
   inline lsn_t GetLSN() { return *reinterpret_cast<lsn_t *>(GetData() + OFFSET_LSN); }
 
   /** Sets the page LSN. */
   inline void SetLSN(lsn_t lsn) { memcpy(GetData() + OFFSET_LSN, &lsn, sizeof(lsn_t)); }
 
+  /** Optimistic attempts ReadOptimistically makes before it takes the read latch. */
+  static constexpr int MAX_OPTIMISTIC_ATTEMPTS = 4;
+
  protected:
   static_assert(sizeof(page_id_t) == 4);
   static_assert(sizeof(lsn_t) == 4);
@@ -78,16 +141,18 @@ class Page {
   /** Zeroes out the data that is held within the page. */
   inline void ResetMemory() { memset(data_, OFFSET_PAGE_START, PAGE_SIZE); }
 
-  /** The actual data that is stored within a page. */
-  char data_[PAGE_SIZE]{};
+  /** The actual data that is stored within a page, PAGE_SIZE bytes owned by the buffer pool's FrameArena. */
+  char *data_{nullptr};
   /** The ID of this page. */
   page_id_t page_id_ = INVALID_PAGE_ID;
-  /** The pin count of this page. */
-  int pin_count_ = 0;
+  /** The pin count of this page. Atomic so that a buffer pool hit can pin the page without the pool latch. */
+  std::atomic<int> pin_count_{0};
   /** True if the page is dirty, i.e. it is different from its corresponding page on disk. */
-  bool is_dirty_ = false;
+  std::atomic<bool> is_dirty_{false};
   /** Page latch. */
   ReaderWriterLatch rwlatch_;
+  /** Bumped by WLatch and WUnlatch: odd while a writer holds the latch. See OptimisticReadBegin. */
+  std::atomic<uint64_t> version_{0};
 };
 
 }  // namespace bustub
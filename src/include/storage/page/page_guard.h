@@ -0,0 +1,196 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// page_guard.h
+//
+// Identification: src/include/storage/page/page_guard.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include "common/config.h"
+#include "common/macros.h"
+#include "storage/page/page.h"
+
+namespace bustub {
+
+class BufferPoolManager;
+class ReadPageGuard;
+class WritePageGuard;
+
+/**
+ * BasicPageGuard owns the pin of a page: it unpins the page when it goes out of scope or is dropped, marking the page
+ * dirty if it was modified through the guard. Guards are move-only, so that every pin is released exactly once.
+ *
+ * A guard whose fetch failed holds no page, see IsValid.
+ */
+class BasicPageGuard {
+ public:
+  BasicPageGuard() = default;
+  BasicPageGuard(BufferPoolManager *bpm, Page *page) : bpm_(bpm), page_(page) {}
+  ~BasicPageGuard() { Drop(); }
+
+  DISALLOW_COPY(BasicPageGuard);
+
+  BasicPageGuard(BasicPageGuard &&that) noexcept;
+  BasicPageGuard &operator=(BasicPageGuard &&that) noexcept;
+
+  /** Unpin the page now instead of at the end of the scope. The guard is empty afterwards. */
+  void Drop();
+
+  /**
+   * Read latch the page and hand the pin over to a ReadPageGuard. This guard is empty afterwards.
+   * @return the read guard, empty if this guard is empty
+   */
+  ReadPageGuard UpgradeRead();
+
+  /**
+   * Write latch the page and hand the pin over to a WritePageGuard. This guard is empty afterwards.
+   * @return the write guard, empty if this guard is empty
+   */
+  WritePageGuard UpgradeWrite();
+
+  /** @return true if the guard holds a page */
+  bool IsValid() const { return page_ != nullptr; }
+
+  /** @return the id of the guarded page, INVALID_PAGE_ID if the guard is empty */
+  page_id_t PageId() const { return page_ == nullptr ? INVALID_PAGE_ID : page_->GetPageId(); }
+
+  /** @return the guarded page. Modifying it through this pointer does not mark it dirty, see SetDirty. */
+  Page *GetPage() const { return page_; }
+
+  /** @return the page data, for reading */
+  const char *GetData() const { return page_->GetData(); }
+
+  /** @return the page data, for writing. The page is unpinned dirty. */
+  char *GetDataMut() {
+    is_dirty_ = true;
+    return page_->GetData();
+  }
+
+  /** @return the page data viewed as T, for reading */
+  template <class T>
+  const T *As() const {
+    return reinterpret_cast<const T *>(GetData());
+  }
+
+  /** @return the page data viewed as T, for writing. The page is unpinned dirty. */
+  template <class T>
+  T *AsMut() {
+    return reinterpret_cast<T *>(GetDataMut());
+  }
+
+  /** Unpin the page dirty, for pages modified through GetPage. */
+  void SetDirty() { is_dirty_ = true; }
+
+ private:
+  friend class ReadPageGuard;
+  friend class WritePageGuard;
+
+  BufferPoolManager *bpm_{nullptr};
+  Page *page_{nullptr};
+  bool is_dirty_{false};
+};
+
+/**
+ * ReadPageGuard owns the pin and the read latch of a page, and releases both when it goes out of scope or is dropped.
+ */
+class ReadPageGuard {
+ public:
+  ReadPageGuard() = default;
+  /** Takes over the pin of page, which the caller must have read latched already. */
+  ReadPageGuard(BufferPoolManager *bpm, Page *page) : guard_(bpm, page) {}
+  ~ReadPageGuard() { Drop(); }
+
+  DISALLOW_COPY(ReadPageGuard);
+
+  ReadPageGuard(ReadPageGuard &&that) noexcept = default;
+  ReadPageGuard &operator=(ReadPageGuard &&that) noexcept;
+
+  /** Unlatch and unpin the page now instead of at the end of the scope. The guard is empty afterwards. */
+  void Drop();
+
+  /** @return true if the guard holds a page */
+  bool IsValid() const { return guard_.IsValid(); }
+
+  /** @return the id of the guarded page, INVALID_PAGE_ID if the guard is empty */
+  page_id_t PageId() const { return guard_.PageId(); }
+
+  /** @return the guarded page, which must only be read */
+  Page *GetPage() const { return guard_.GetPage(); }
+
+  /** @return the page data */
+  const char *GetData() const { return guard_.GetData(); }
+
+  /** @return the page data viewed as T */
+  template <class T>
+  const T *As() const {
+    return guard_.As<T>();
+  }
+
+ private:
+  friend class BasicPageGuard;
+
+  BasicPageGuard guard_;
+};
+
+/**
+ * WritePageGuard owns the pin and the write latch of a page, and releases both when it goes out of scope or is
+ * dropped. The page is unpinned dirty if it was modified through GetDataMut/AsMut or marked with SetDirty.
+ */
+class WritePageGuard {
+ public:
+  WritePageGuard() = default;
+  /** Takes over the pin of page, which the caller must have write latched already. */
+  WritePageGuard(BufferPoolManager *bpm, Page *page) : guard_(bpm, page) {}
+  ~WritePageGuard() { Drop(); }
+
+  DISALLOW_COPY(WritePageGuard);
+
+  WritePageGuard(WritePageGuard &&that) noexcept = default;
+  WritePageGuard &operator=(WritePageGuard &&that) noexcept;
+
+  /** Unlatch and unpin the page now instead of at the end of the scope. The guard is empty afterwards. */
+  void Drop();
+
+  /** @return true if the guard holds a page */
+  bool IsValid() const { return guard_.IsValid(); }
+
+  /** @return the id of the guarded page, INVALID_PAGE_ID if the guard is empty */
+  page_id_t PageId() const { return guard_.PageId(); }
+
+  /** @return the guarded page. Modifying it through this pointer does not mark it dirty, see SetDirty. */
+  Page *GetPage() const { return guard_.GetPage(); }
+
+  /** @return the page data, for reading */
+  const char *GetData() const { return guard_.GetData(); }
+
+  /** @return the page data, for writing. The page is unpinned dirty. */
+  char *GetDataMut() { return guard_.GetDataMut(); }
+
+  /** @return the page data viewed as T, for reading */
+  template <class T>
+  const T *As() const {
+    return guard_.As<T>();
+  }
+
+  /** @return the page data viewed as T, for writing. The page is unpinned dirty. */
+  template <class T>
+  T *AsMut() {
+    return guard_.AsMut<T>();
+  }
+
+  /** Unpin the page dirty, for pages modified through GetPage. */
+  void SetDirty() { guard_.SetDirty(); }
+
+ private:
+  friend class BasicPageGuard;
+
+  BasicPageGuard guard_;
+};
+
+}  // namespace bustub
@@ -99,8 +99,12 @@ class TableHeap {
    */
   bool GetTuple(const RID &rid, Tuple *tuple, Transaction *txn);
 
-  /** @return the begin iterator of this table */
-  TableIterator Begin(Transaction *txn);
+  /**
+   * @param txn transaction performing the scan
+   * @param strategy access strategy the scan reads pages through, nullptr to use the shared pool
+   * @return the begin iterator of this table
+   */
+  TableIterator Begin(Transaction *txn, BufferAccessStrategy *strategy = nullptr);
 
   /** @return the end iterator of this table */
   TableIterator End();
@@ -14,6 +14,7 @@
 
 #include <cassert>
 
+#include "buffer/buffer_access_strategy.h"
 #include "common/rid.h"
 #include "concurrency/transaction.h"
 #include "storage/table/tuple.h"
@@ -23,16 +24,20 @@ namespace bustub {
 class TableHeap;
 
 /**
- * TableIterator enables the sequential scan of a TableHeap.
+ * TableIterator enables the sequential scan of a TableHeap. If the iterator was given an access strategy, the pages it
+ * visits are read through that strategy's ring of frames.
  */
 class TableIterator {
   friend class Cursor;
 
  public:
-  TableIterator(TableHeap *table_heap, RID rid, Transaction *txn);
+  TableIterator(TableHeap *table_heap, RID rid, Transaction *txn, BufferAccessStrategy *strategy = nullptr);
 
   TableIterator(const TableIterator &other)
-      : table_heap_(other.table_heap_), tuple_(new Tuple(*other.tuple_)), txn_(other.txn_) {}
+      : table_heap_(other.table_heap_),
+        tuple_(new Tuple(*other.tuple_)),
+        txn_(other.txn_),
+        strategy_(other.strategy_) {}
 
   ~TableIterator() { delete tuple_; }
 
@@ -52,6 +57,7 @@ class TableIterator {
     table_heap_ = other.table_heap_;
     *tuple_ = *other.tuple_;
     txn_ = other.txn_;
+    strategy_ = other.strategy_;
     return *this;
   }
 
@@ -59,6 +65,7 @@ class TableIterator {
   TableHeap *table_heap_;
   Tuple *tuple_;
   Transaction *txn_;
+  BufferAccessStrategy *strategy_;
 };
 
 }  // namespace bustub
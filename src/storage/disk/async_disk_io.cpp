@@ -0,0 +1,322 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// async_disk_io.cpp
+//
+// Identification: src/storage/disk/async_disk_io.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/disk/async_disk_io.h"
+
+#include <sys/mman.h>
+#include <unistd.h>
+
+#ifdef BUSTUB_HAVE_IO_URING
+#include <linux/io_uring.h>
+#include <sys/syscall.h>
+#endif
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <limits>
+#include <utility>
+
+#include "common/exception.h"
+#include "common/logger.h"
+
+namespace bustub {
+
+/** user_data of the NOP that tells the completion thread to stop. */
+static constexpr uint64_t STOP_USER_DATA = std::numeric_limits<uint64_t>::max();
+
+#ifdef BUSTUB_HAVE_IO_URING
+// 没有依赖liburing，直接使用系统调用
+static int IoUringSetup(unsigned entries, io_uring_params *params) {
+  return static_cast<int>(syscall(__NR_io_uring_setup, entries, params));
+}
+
+static int IoUringEnter(int ring_fd, unsigned to_submit, unsigned min_complete, unsigned flags) {
+  return static_cast<int>(syscall(__NR_io_uring_enter, ring_fd, to_submit, min_complete, flags, nullptr, 0));
+}
+#endif
+
+AsyncDiskIo::AsyncDiskIo(int fd, size_t queue_depth, size_t num_threads, bool use_io_uring)
+    : fd_(fd), queue_depth_(queue_depth) {
+  BUSTUB_ASSERT(queue_depth > 0, "at least one request must be able to be in flight");
+  if (use_io_uring && SetUpRing(queue_depth)) {
+    completion_thread_ = std::thread(&AsyncDiskIo::CompletionThreadMain, this);
+    return;
+  }
+  // 内核不支持io_uring（或者被禁用）时退化为线程池
+  for (size_t i = 0; i < std::max<size_t>(num_threads, 1); ++i) {
+    workers_.emplace_back(&AsyncDiskIo::WorkerThreadMain, this);
+  }
+}
+
+AsyncDiskIo::~AsyncDiskIo() {
+  if (ring_fd_ < 0) {
+    {
+      std::scoped_lock lk{queue_latch_};
+      stop_ = true;
+    }
+    queue_cv_.notify_all();
+    for (auto &worker : workers_) {
+      worker.join();
+    }
+    return;
+  }
+#ifdef BUSTUB_HAVE_IO_URING
+  {
+    // 等所有请求完成，再用一个NOP叫醒完成线程让它退出
+    std::unique_lock lk{ring_latch_};
+    slot_cv_.wait(lk, [this] { return free_slots_.size() == slots_.size(); });
+    unsigned tail = *sq_tail_;
+    unsigned index = tail & *sq_mask_;
+    auto *sqe = static_cast<io_uring_sqe *>(sqes_) + index;
+    memset(sqe, 0, sizeof(*sqe));
+    sqe->opcode = IORING_OP_NOP;
+    sqe->user_data = STOP_USER_DATA;
+    sq_array_[index] = index;
+    __atomic_store_n(sq_tail_, tail + 1, __ATOMIC_RELEASE);
+    EnterRing(1);
+  }
+  completion_thread_.join();
+  TearDownRing(ring_fd_);
+#endif
+}
+
+void AsyncDiskIo::Submit(DiskRequest request) {
+  std::vector<DiskRequest> requests;
+  requests.push_back(std::move(request));
+  Submit(&requests);
+}
+
+void AsyncDiskIo::Submit(std::vector<DiskRequest> *requests) {
+  if (ring_fd_ >= 0) {
+    SubmitToRing(requests);
+    return;
+  }
+  for (auto &request : *requests) {
+    {
+      std::unique_lock lk{queue_latch_};
+      space_cv_.wait(lk, [this] { return queue_.size() < queue_depth_; });
+      queue_.push_back(std::move(request));
+    }
+    queue_cv_.notify_one();
+  }
+}
+
+bool AsyncDiskIo::SetUpRing(size_t queue_depth) {
+#ifdef BUSTUB_HAVE_IO_URING
+  io_uring_params params;
+  memset(&params, 0, sizeof(params));
+  int ring_fd = IoUringSetup(static_cast<unsigned>(queue_depth), &params);
+  if (ring_fd < 0) {
+    return false;
+  }
+  sq_ring_size_ = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+  cq_ring_size_ = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+  // 新内核的提交环和完成环在同一个映射里
+  bool single_mmap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+  if (single_mmap) {
+    sq_ring_size_ = cq_ring_size_ = std::max(sq_ring_size_, cq_ring_size_);
+  }
+  void *sq_ring = mmap(nullptr, sq_ring_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd,
+                       IORING_OFF_SQ_RING);
+  if (sq_ring == MAP_FAILED) {
+    TearDownRing(ring_fd);
+    return false;
+  }
+  sq_ring_ = sq_ring;
+  if (single_mmap) {
+    cq_ring_ = sq_ring_;
+  } else {
+    void *cq_ring = mmap(nullptr, cq_ring_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd,
+                         IORING_OFF_CQ_RING);
+    if (cq_ring == MAP_FAILED) {
+      TearDownRing(ring_fd);
+      return false;
+    }
+    cq_ring_ = cq_ring;
+  }
+  sqes_size_ = params.sq_entries * sizeof(io_uring_sqe);
+  void *sqes = mmap(nullptr, sqes_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd, IORING_OFF_SQES);
+  if (sqes == MAP_FAILED) {
+    TearDownRing(ring_fd);
+    return false;
+  }
+  sqes_ = sqes;
+
+  auto *sq = static_cast<char *>(sq_ring_);
+  auto *cq = static_cast<char *>(cq_ring_);
+  sq_tail_ = reinterpret_cast<unsigned *>(sq + params.sq_off.tail);
+  sq_mask_ = reinterpret_cast<unsigned *>(sq + params.sq_off.ring_mask);
+  sq_array_ = reinterpret_cast<unsigned *>(sq + params.sq_off.array);
+  cq_head_ = reinterpret_cast<unsigned *>(cq + params.cq_off.head);
+  cq_tail_ = reinterpret_cast<unsigned *>(cq + params.cq_off.tail);
+  cq_mask_ = reinterpret_cast<unsigned *>(cq + params.cq_off.ring_mask);
+  cqes_ = cq + params.cq_off.cqes;
+
+  // 每个slot固定对应一个SQE；完成环的大小是提交环的两倍，在途请求不超过slot数就不会溢出
+  slots_ = std::vector<Slot>(params.sq_entries);
+  for (unsigned i = params.sq_entries; i > 0; --i) {
+    free_slots_.push_back(i - 1);
+  }
+  ring_fd_ = ring_fd;
+  return true;
+#else
+  return false;
+#endif
+}
+
+void AsyncDiskIo::TearDownRing(int ring_fd) {
+  if (sqes_ != nullptr) {
+    munmap(sqes_, sqes_size_);
+  }
+  if (cq_ring_ != nullptr && cq_ring_ != sq_ring_) {
+    munmap(cq_ring_, cq_ring_size_);
+  }
+  if (sq_ring_ != nullptr) {
+    munmap(sq_ring_, sq_ring_size_);
+  }
+  sqes_ = cq_ring_ = sq_ring_ = nullptr;
+  close(ring_fd);
+}
+
+void AsyncDiskIo::EnterRing(unsigned to_submit) {
+#ifdef BUSTUB_HAVE_IO_URING
+  while (to_submit > 0) {
+    int submitted = IoUringEnter(ring_fd_, to_submit, 0, 0);
+    if (submitted < 0) {
+      if (errno == EINTR || errno == EAGAIN || errno == EBUSY) {
+        continue;
+      }
+      throw Exception("io_uring_enter failed");
+    }
+    to_submit -= submitted;
+  }
+#endif
+}
+
+void AsyncDiskIo::SubmitToRing(std::vector<DiskRequest> *requests) {
+#ifdef BUSTUB_HAVE_IO_URING
+  std::unique_lock lk{ring_latch_};
+  size_t next = 0;
+  while (next < requests->size()) {
+    // 在途请求达到队列深度时等待完成
+    slot_cv_.wait(lk, [this] { return !free_slots_.empty(); });
+    unsigned tail = *sq_tail_;
+    unsigned to_submit = 0;
+    while (next < requests->size() && !free_slots_.empty()) {
+      unsigned index = free_slots_.back();
+      free_slots_.pop_back();
+      Slot &slot = slots_[index];
+      slot.request_ = std::move((*requests)[next++]);
+      slot.iov_ = {slot.request_.data_, PAGE_SIZE};
+      auto *sqe = static_cast<io_uring_sqe *>(sqes_) + index;
+      memset(sqe, 0, sizeof(*sqe));
+      sqe->opcode = slot.request_.is_write_ ? IORING_OP_WRITEV : IORING_OP_READV;
+      sqe->fd = fd_;
+      sqe->off = static_cast<uint64_t>(slot.request_.page_id_) * PAGE_SIZE;
+      sqe->addr = reinterpret_cast<uint64_t>(&slot.iov_);
+      sqe->len = 1;
+      sqe->user_data = index;
+      sq_array_[(tail + to_submit) & *sq_mask_] = index;
+      to_submit++;
+    }
+    // 一次系统调用提交这一批请求
+    __atomic_store_n(sq_tail_, tail + to_submit, __ATOMIC_RELEASE);
+    EnterRing(to_submit);
+  }
+#endif
+}
+
+void AsyncDiskIo::CompletionThreadMain() {
+#ifdef BUSTUB_HAVE_IO_URING
+  while (true) {
+    unsigned head = *cq_head_;
+    unsigned tail = __atomic_load_n(cq_tail_, __ATOMIC_ACQUIRE);
+    if (head == tail) {
+      IoUringEnter(ring_fd_, 0, 1, IORING_ENTER_GETEVENTS);
+      continue;
+    }
+    bool stop = false;
+    for (; head != tail; ++head) {
+      auto *cqe = static_cast<io_uring_cqe *>(cqes_) + (head & *cq_mask_);
+      if (cqe->user_data == STOP_USER_DATA) {
+        stop = true;
+        continue;
+      }
+      auto index = static_cast<unsigned>(cqe->user_data);
+      DiskRequest request;
+      {
+        std::scoped_lock lk{ring_latch_};
+        request = std::move(slots_[index].request_);
+        free_slots_.push_back(index);
+      }
+      slot_cv_.notify_all();
+      Complete(&request, cqe->res);
+    }
+    __atomic_store_n(cq_head_, head, __ATOMIC_RELEASE);
+    if (stop) {
+      return;
+    }
+  }
+#endif
+}
+
+void AsyncDiskIo::WorkerThreadMain() {
+  while (true) {
+    DiskRequest request;
+    {
+      std::unique_lock lk{queue_latch_};
+      queue_cv_.wait(lk, [this] { return stop_ || !queue_.empty(); });
+      // 退出之前先做完排队的请求
+      if (queue_.empty()) {
+        return;
+      }
+      request = std::move(queue_.front());
+      queue_.pop_front();
+    }
+    space_cv_.notify_one();
+    Complete(&request, 0);
+  }
+}
+
+void AsyncDiskIo::Complete(DiskRequest *request, int64_t done) {
+  if (done < 0) {
+    LOG_DEBUG("I/O error on page %d", request->page_id_);
+    request->callback_.set_value(false);
+    return;
+  }
+  auto offset = static_cast<off_t>(request->page_id_) * PAGE_SIZE;
+  // 没做完的部分（短读短写，或者线程池的整个请求）用pread/pwrite补上
+  while (done < PAGE_SIZE) {
+    char *data = request->data_ + done;
+    size_t remaining = PAGE_SIZE - done;
+    ssize_t transferred = request->is_write_ ? pwrite(fd_, data, remaining, offset + done)
+                                             : pread(fd_, data, remaining, offset + done);
+    if (transferred < 0 && errno == EINTR) {
+      continue;
+    }
+    if (transferred < 0 || (transferred == 0 && request->is_write_)) {
+      LOG_DEBUG("I/O error on page %d", request->page_id_);
+      request->callback_.set_value(false);
+      return;
+    }
+    if (transferred == 0) {
+      // 读到了文件末尾之后，剩下的部分按全0处理
+      memset(data, 0, remaining);
+      break;
+    }
+    done += transferred;
+  }
+  request->callback_.set_value(true);
+}
+
+}  // namespace bustub
@@ -10,27 +10,80 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <fcntl.h>
 #include <sys/stat.h>
+#include <unistd.h>
 #include <cassert>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
 #include <cstring>
+#include <fstream>
 #include <iostream>
+#include <memory>
 #include <mutex>  // NOLINT
 #include <string>
 #include <thread>  // NOLINT
+#include <utility>
 
 #include "common/exception.h"
 #include "common/logger.h"
+#include "common/macros.h"
 #include "storage/disk/disk_manager.h"
 
 namespace bustub {
 
 static char *buffer_used;
 
+/** First word of the free page file. */
+static constexpr uint32_t FSM_MAGIC = 0x4d534642;  // "BFSM"
+/** Freed pages AllocateFreePage takes out of the free page file with one write. */
+static constexpr size_t FREE_PAGE_BATCH = 32;
+
+/** Frees memory from aligned_alloc. */
+struct FreeDeleter {
+  void operator()(char *p) const { free(p); }
+};
+
+/** @return this thread's buffer for direct I/O of unaligned data, size bytes aligned for O_DIRECT */
+static char *BounceBuffer(size_t size) {
+  static thread_local std::unique_ptr<char, FreeDeleter> buffer;
+  static thread_local size_t capacity = 0;
+  if (capacity < size) {
+    buffer.reset(static_cast<char *>(std::aligned_alloc(DiskManager::DIRECT_IO_ALIGNMENT, size)));
+    capacity = size;
+  }
+  return buffer.get();
+}
+
+/**
+ * pread up to size bytes at offset, stopping at the end of the file
+ * @return the number of bytes read, -1 on an I/O error
+ */
+static ssize_t ReadFully(int fd, char *data, size_t size, off_t offset, bool direct_io) {
+  size_t read_count = 0;
+  while (read_count < size) {
+    ssize_t n = pread(fd, data + read_count, size - read_count, offset + read_count);
+    if (n < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      return -1;
+    }
+    read_count += n;
+    // 直接I/O的短读只会出现在文件末尾，而且再读一次的偏移不再对齐
+    if (n == 0 || direct_io) {
+      break;
+    }
+  }
+  return static_cast<ssize_t>(read_count);
+}
+
 /**
  * Constructor: open/create a single database file & log file
  * @input db_file: database file name
  */
-DiskManager::DiskManager(const std::string &db_file)
+DiskManager::DiskManager(const std::string &db_file, const DiskManagerOptions &options)
     : file_name_(db_file), num_flushes_(0), num_writes_(0), flush_log_(false), flush_log_f_(nullptr) {
   std::string::size_type n = file_name_.rfind('.');
   if (n == std::string::npos) {
@@ -38,6 +91,7 @@ DiskManager::DiskManager(const std::string &db_file)
     return;
   }
   log_name_ = file_name_.substr(0, n) + ".log";
+  fsm_name_ = file_name_.substr(0, n) + ".fsm";
 
   log_io_.open(log_name_, std::ios::binary | std::ios::in | std::ios::app | std::ios::out);
   // directory or file does not exist
@@ -53,30 +107,59 @@ DiskManager::DiskManager(const std::string &db_file)
     }
   }
 
-  std::scoped_lock scoped_db_io_latch(db_io_latch_);
-  db_io_.open(db_file, std::ios::binary | std::ios::in | std::ios::out);
-  // directory or file does not exist
-  if (!db_io_.is_open()) {
-    db_io_.clear();
-    // create a new file
-    db_io_.open(db_file, std::ios::binary | std::ios::trunc | std::ios::out);
-    db_io_.close();
-    // reopen with original mode
-    db_io_.open(db_file, std::ios::binary | std::ios::in | std::ios::out);
-    if (!db_io_.is_open()) {
-      throw Exception("can't open db file");
+  // 页面读写都用pread/pwrite，各自带偏移，不共享游标，也就不需要加锁
+  if (options.direct_io_) {
+    db_fd_ = open(db_file.c_str(), O_RDWR | O_CREAT | O_DIRECT, 0666);
+    // 有的文件系统（比如老内核上的tmpfs）打开时就拒绝O_DIRECT，有的要到第一次读写才报EINVAL，所以先试读一页
+    direct_io_ = db_fd_ >= 0 && ReadFully(db_fd_, BounceBuffer(PAGE_SIZE), PAGE_SIZE, 0, true) >= 0;
+    if (!direct_io_) {
+      LOG_WARN("%s does not support direct I/O, falling back to buffered I/O", db_file.c_str());
+      if (db_fd_ >= 0) {
+        close(db_fd_);
+        db_fd_ = -1;
+      }
     }
   }
+  if (db_fd_ < 0) {
+    db_fd_ = open(db_file.c_str(), O_RDWR | O_CREAT, 0666);
+  }
+  if (db_fd_ < 0) {
+    throw Exception("can't open db file");
+  }
+  // 之后文件只会经由这个对象变长，大小记在内存里，读页面时不用再stat
+  struct stat stat_buf;
+  if (fstat(db_fd_, &stat_buf) != 0) {
+    throw Exception("can't stat db file");
+  }
+  db_file_size_ = static_cast<int64_t>(stat_buf.st_size);
+  LoadFreePages();
+  if (options.async_io_) {
+    async_io_ = std::make_unique<AsyncDiskIo>(db_fd_, options.io_queue_depth_, options.io_threads_, options.io_uring_);
+  }
   buffer_used = nullptr;
 }
 
+DiskManager::~DiskManager() {
+  // 先等在途的请求做完，再关闭它们使用的文件
+  async_io_.reset();
+  if (db_fd_ >= 0) {
+    SaveFreePages(true);
+    close(db_fd_);
+  }
+}
+
 /**
  * Close all file streams
  */
 void DiskManager::ShutDown() {
+  async_io_.reset();
+  SaveFreePages(true);
   {
     std::scoped_lock scoped_db_io_latch(db_io_latch_);
-    db_io_.close();
+    if (db_fd_ >= 0) {
+      close(db_fd_);
+      db_fd_ = -1;
+    }
   }
   log_io_.close();
 }
@@ -85,48 +168,386 @@ void DiskManager::ShutDown() {
  * Write the contents of the specified page into disk file
  */
 void DiskManager::WritePage(page_id_t page_id, const char *page_data) {
-  std::scoped_lock scoped_db_io_latch(db_io_latch_);
-  size_t offset = static_cast<size_t>(page_id) * PAGE_SIZE;
-  // set write cursor to offset
-  num_writes_ += 1;
-  db_io_.seekp(offset);
-  db_io_.write(page_data, PAGE_SIZE);
-  // check for I/O error
-  if (db_io_.bad()) {
-    LOG_DEBUG("I/O error while writing");
+  if (async_io_ != nullptr) {
+    WritePageAsync(page_id, page_data).get();
     return;
   }
-  // needs to flush to keep disk file in sync
-  db_io_.flush();
+  WritePages(page_id, page_data, 1);
+}
+
+/**
+ * Write a run of pages with consecutive ids, without flushing
+ */
+void DiskManager::WritePages(page_id_t first_page_id, const char *pages_data, size_t num_pages) {
+  if (page_cache_ != nullptr) {
+    for (size_t i = 0; i < num_pages; i++) {
+      page_cache_->Invalidate(first_page_id + static_cast<page_id_t>(i));
+    }
+  }
+  size_t remaining = num_pages * PAGE_SIZE;
+  if (!IsAligned(pages_data)) {
+    char *bounce = BounceBuffer(remaining);
+    memcpy(bounce, pages_data, remaining);
+    pages_data = bounce;
+  }
+  // pwrite has its own offset, so concurrent writes of different pages need no latch
+  auto offset = static_cast<off_t>(first_page_id) * PAGE_SIZE;
+  while (remaining > 0) {
+    ssize_t written = pwrite(db_fd_, pages_data, remaining, offset);
+    if (written < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      LOG_DEBUG("I/O error while writing");
+      return;
+    }
+    pages_data += written;
+    offset += written;
+    remaining -= written;
+  }
+  ExtendDbFileSize(offset);
+  num_writes_ += static_cast<int>(num_pages);
+}
+
+/**
+ * Flush the db file to stable storage
+ */
+void DiskManager::Sync() {
+  if (fdatasync(db_fd_) != 0) {
+    LOG_DEBUG("I/O error while syncing");
+  }
+  SaveFreePages();
+}
+
+/**
+ * Stripe the free pages over num_instances buffer pool instances
+ */
+void DiskManager::SetNumInstances(uint32_t num_instances) {
+  BUSTUB_ASSERT(num_instances > 0, "at least one buffer pool instance");
+  std::scoped_lock lk{free_pages_latch_};
+  if (free_pages_.size() == num_instances) {
+    return;
+  }
+  for (auto *pages : {&free_pages_, &reserved_pages_}) {
+    std::vector<std::set<page_id_t>> striped(num_instances);
+    for (const auto &stripe : *pages) {
+      for (page_id_t page_id : stripe) {
+        striped[page_id % num_instances].insert(page_id);
+      }
+    }
+    *pages = std::move(striped);
+  }
+}
+
+/**
+ * Put a page on the free list
+ */
+void DiskManager::DeallocatePage(page_id_t page_id) {
+  BUSTUB_ASSERT(page_id >= 0, "invalid page id");
+  // 二级缓存里的副本属于被删除的页面，不能让复用这个id的页面读到
+  if (page_cache_ != nullptr) {
+    page_cache_->Invalidate(page_id);
+  }
+  std::scoped_lock lk{free_pages_latch_};
+  free_pages_[page_id % free_pages_.size()].insert(page_id);
+  free_pages_dirty_ = true;
+}
+
+/**
+ * Take the lowest free page of a stripe
+ */
+page_id_t DiskManager::AllocateFreePage(uint32_t instance_index) {
+  std::scoped_lock lk{free_pages_latch_};
+  BUSTUB_ASSERT(instance_index < free_pages_.size(), "instance index out of range");
+  auto &stripe = free_pages_[instance_index];
+  auto &reserved = reserved_pages_[instance_index];
+  // 优先复用靠前的页面，文件末尾的空闲页面才有机会被截掉。预留的页面已经不在空闲页面文件里，可以直接交出去；
+  // 否则把最靠前的一批页面移出文件，写一次文件分配一批，而不是每个页面写一次
+  if (!stripe.empty() && (reserved.empty() || *stripe.begin() < *reserved.begin())) {
+    std::vector<page_id_t> batch;
+    for (auto iter = stripe.begin(); iter != stripe.end() && batch.size() < FREE_PAGE_BATCH;) {
+      batch.push_back(*iter);
+      iter = stripe.erase(iter);
+    }
+    reserved.insert(batch.begin(), batch.end());
+    free_pages_dirty_ = true;
+    // 交出去之前先让空闲页面文件去掉它们，否则崩溃重启后同一个页面会被再分配一次
+    if (!WriteFreePages()) {
+      for (page_id_t page_id : batch) {
+        reserved.erase(page_id);
+      }
+      stripe.insert(batch.begin(), batch.end());
+      return INVALID_PAGE_ID;
+    }
+  }
+  if (reserved.empty()) {
+    return INVALID_PAGE_ID;
+  }
+  page_id_t page_id = *reserved.begin();
+  reserved.erase(reserved.begin());
+  return page_id;
+}
+
+/**
+ * Returns number of free pages
+ */
+size_t DiskManager::GetNumFreePages() {
+  std::scoped_lock lk{free_pages_latch_};
+  size_t num_free_pages = 0;
+  for (const auto &stripe : free_pages_) {
+    num_free_pages += stripe.size();
+  }
+  for (const auto &stripe : reserved_pages_) {
+    num_free_pages += stripe.size();
+  }
+  return num_free_pages;
+}
+
+/**
+ * Cut the free pages at the end of the db file off
+ */
+size_t DiskManager::TruncateFreePages() {
+  std::scoped_lock lk{free_pages_latch_};
+  auto num_pages = static_cast<page_id_t>((db_file_size_.load() + PAGE_SIZE - 1) / PAGE_SIZE);
+  // 预留还没交出去的页面也是空闲的
+  auto is_free = [this](page_id_t page_id) {
+    size_t stripe = page_id % free_pages_.size();
+    return free_pages_[stripe].count(page_id) > 0 || reserved_pages_[stripe].count(page_id) > 0;
+  };
+  page_id_t end = num_pages;
+  while (end > 0 && is_free(end - 1)) {
+    end--;
+  }
+  if (end == num_pages) {
+    return 0;
+  }
+  if (ftruncate(db_fd_, static_cast<off_t>(end) * PAGE_SIZE) != 0) {
+    LOG_DEBUG("I/O error while truncating");
+    return 0;
+  }
+  for (page_id_t page_id = end; page_id < num_pages; page_id++) {
+    free_pages_[page_id % free_pages_.size()].erase(page_id);
+    reserved_pages_[page_id % free_pages_.size()].erase(page_id);
+  }
+  db_file_size_ = static_cast<int64_t>(end) * PAGE_SIZE;
+  free_pages_dirty_ = true;
+  return num_pages - end;
+}
+
+/**
+ * Private helper function to read the free page file
+ */
+void DiskManager::LoadFreePages() {
+  std::ifstream in(fsm_name_, std::ios::binary);
+  if (!in.is_open()) {
+    return;
+  }
+  uint32_t magic = 0;
+  uint32_t count = 0;
+  in.read(reinterpret_cast<char *>(&magic), sizeof(magic));
+  in.read(reinterpret_cast<char *>(&count), sizeof(count));
+  if (!in || magic != FSM_MAGIC) {
+    LOG_WARN("ignoring corrupt free page file %s", fsm_name_.c_str());
+    return;
+  }
+  std::vector<page_id_t> page_ids(count);
+  in.read(reinterpret_cast<char *>(page_ids.data()), count * sizeof(page_id_t));
+  if (!in) {
+    LOG_WARN("ignoring corrupt free page file %s", fsm_name_.c_str());
+    return;
+  }
+  // 文件之外的页面本来就会从文件末尾重新分配，不能再留在空闲列表里
+  auto num_pages = static_cast<page_id_t>((db_file_size_.load() + PAGE_SIZE - 1) / PAGE_SIZE);
+  for (page_id_t page_id : page_ids) {
+    if (page_id >= 0 && page_id < num_pages) {
+      free_pages_[0].insert(page_id);
+    }
+  }
+}
+
+/**
+ * Private helper function to write the free page file if it is out of date
+ */
+void DiskManager::SaveFreePages(bool release_reserved) {
+  std::scoped_lock lk{free_pages_latch_};
+  // 不再分配页面时，预留的页面回到空闲页面文件中
+  for (size_t i = 0; release_reserved && i < reserved_pages_.size(); i++) {
+    if (!reserved_pages_[i].empty()) {
+      free_pages_[i].insert(reserved_pages_[i].begin(), reserved_pages_[i].end());
+      reserved_pages_[i].clear();
+      free_pages_dirty_ = true;
+    }
+  }
+  if (free_pages_dirty_) {
+    WriteFreePages();
+  }
+}
+
+/**
+ * Private helper function to write the free page file durably, free_pages_latch_ held
+ */
+bool DiskManager::WriteFreePages() {
+  if (fsm_name_.empty()) {
+    free_pages_dirty_ = false;
+    return true;
+  }
+  std::vector<char> buffer(2 * sizeof(uint32_t));
+  for (const auto &stripe : free_pages_) {
+    for (page_id_t page_id : stripe) {
+      const auto *bytes = reinterpret_cast<const char *>(&page_id);
+      buffer.insert(buffer.end(), bytes, bytes + sizeof(page_id));
+    }
+  }
+  auto count = static_cast<uint32_t>((buffer.size() - 2 * sizeof(uint32_t)) / sizeof(page_id_t));
+  memcpy(buffer.data(), &FSM_MAGIC, sizeof(FSM_MAGIC));
+  memcpy(buffer.data() + sizeof(FSM_MAGIC), &count, sizeof(count));
+
+  // 先写临时文件、刷盘再改名，崩溃时要么是旧的列表要么是新的列表
+  std::string tmp_name = fsm_name_ + ".tmp";
+  int fd = open(tmp_name.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0666);
+  bool written = fd >= 0;
+  for (size_t done = 0; written && done < buffer.size();) {
+    ssize_t n = write(fd, buffer.data() + done, buffer.size() - done);
+    if (n < 0 && errno == EINTR) {
+      continue;
+    }
+    written = n > 0;
+    done += written ? n : 0;
+  }
+  written = written && fdatasync(fd) == 0;
+  if (fd >= 0) {
+    close(fd);
+  }
+  if (!written || std::rename(tmp_name.c_str(), fsm_name_.c_str()) != 0) {
+    LOG_DEBUG("I/O error while writing the free page file");
+    return false;
+  }
+  // 改名本身也要落盘
+  std::string::size_type slash = fsm_name_.rfind('/');
+  std::string dir_name = slash == std::string::npos ? "." : fsm_name_.substr(0, slash + 1);
+  int dir_fd = open(dir_name.c_str(), O_RDONLY | O_DIRECTORY);
+  if (dir_fd >= 0) {
+    fsync(dir_fd);
+    close(dir_fd);
+  }
+  // 空列表已经落盘，文件删不掉也没关系
+  if (count == 0) {
+    remove(fsm_name_.c_str());
+  }
+  free_pages_dirty_ = false;
+  return true;
 }
 
 /**
  * Read the contents of the specified page into the given memory area
  */
 void DiskManager::ReadPage(page_id_t page_id, char *page_data) {
-  std::scoped_lock scoped_db_io_latch(db_io_latch_);
-  int offset = page_id * PAGE_SIZE;
+  if (async_io_ != nullptr) {
+    ReadPageAsync(page_id, page_data).get();
+    return;
+  }
+  // the page cache holds the same content as the file, on faster storage
+  if (page_cache_ != nullptr && page_cache_->ReadPage(page_id, page_data)) {
+    return;
+  }
+  ReadPageFromFile(page_id, page_data);
+}
+
+void DiskManager::ReadPageFromFile(page_id_t page_id, char *page_data) {
+  auto offset = static_cast<off_t>(page_id) * PAGE_SIZE;
   // check if read beyond file length
-  if (offset > GetFileSize(file_name_)) {
+  if (offset >= db_file_size_.load()) {
     LOG_DEBUG("I/O error reading past end of file");
-    // std::cerr << "I/O error while reading" << std::endl;
-  } else {
-    // set read cursor to offset
-    db_io_.seekp(offset);
-    db_io_.read(page_data, PAGE_SIZE);
-    if (db_io_.bad()) {
-      LOG_DEBUG("I/O error while reading");
-      return;
+    // 和异步路径一样，文件末尾之后的页面读出来是全0
+    memset(page_data, 0, PAGE_SIZE);
+    return;
+  }
+  // pread has its own offset, so concurrent reads of different pages run in parallel
+  char *buffer = IsAligned(page_data) ? page_data : BounceBuffer(PAGE_SIZE);
+  ssize_t read_count = ReadFully(db_fd_, buffer, PAGE_SIZE, offset, direct_io_);
+  if (read_count < 0) {
+    LOG_DEBUG("I/O error while reading");
+    return;
+  }
+  if (buffer != page_data) {
+    memcpy(page_data, buffer, read_count);
+  }
+  // if file ends before reading PAGE_SIZE
+  if (read_count < PAGE_SIZE) {
+    LOG_DEBUG("Read less than a page");
+    memset(page_data + read_count, 0, PAGE_SIZE - read_count);
+  }
+}
+
+/**
+ * Start reading the specified page, through AsyncDiskIo if there is one
+ */
+std::future<bool> DiskManager::ReadPageAsync(page_id_t page_id, char *page_data) {
+  std::vector<DiskRequest> requests(1);
+  requests[0].page_id_ = page_id;
+  requests[0].data_ = page_data;
+  std::future<bool> done = requests[0].callback_.get_future();
+  SubmitRequests(&requests);
+  return done;
+}
+
+/**
+ * Start writing the specified page, through AsyncDiskIo if there is one
+ */
+std::future<bool> DiskManager::WritePageAsync(page_id_t page_id, const char *page_data) {
+  std::vector<DiskRequest> requests(1);
+  requests[0].is_write_ = true;
+  requests[0].page_id_ = page_id;
+  // 写请求不会修改缓冲区
+  requests[0].data_ = const_cast<char *>(page_data);
+  std::future<bool> done = requests[0].callback_.get_future();
+  SubmitRequests(&requests);
+  return done;
+}
+
+/**
+ * Start a batch of page reads and writes
+ */
+void DiskManager::SubmitRequests(std::vector<DiskRequest> *requests) {
+  if (async_io_ == nullptr) {
+    // 同步模式：在当前线程里逐个完成
+    for (auto &request : *requests) {
+      if (request.is_write_) {
+        WritePage(request.page_id_, request.data_);
+      } else {
+        ReadPage(request.page_id_, request.data_);
+      }
+      request.callback_.set_value(true);
     }
-    // if file ends before reading PAGE_SIZE
-    int read_count = db_io_.gcount();
-    if (read_count < PAGE_SIZE) {
-      LOG_DEBUG("Read less than a page");
-      db_io_.clear();
-      // std::cerr << "Read less than a page" << std::endl;
-      memset(page_data + read_count, 0, PAGE_SIZE - read_count);
+    return;
+  }
+  // 和同步路径一样：读先查二级缓存，写让缓存里的副本失效
+  std::vector<DiskRequest> to_submit;
+  to_submit.reserve(requests->size());
+  for (auto &request : *requests) {
+    // O_DIRECT不能直接用没对齐的缓冲区，这些请求经过bounce buffer同步完成
+    if (!IsAligned(request.data_)) {
+      if (request.is_write_) {
+        WritePages(request.page_id_, request.data_, 1);
+      } else if (page_cache_ == nullptr || !page_cache_->ReadPage(request.page_id_, request.data_)) {
+        ReadPageFromFile(request.page_id_, request.data_);
+      }
+      request.callback_.set_value(true);
+      continue;
     }
+    if (request.is_write_) {
+      if (page_cache_ != nullptr) {
+        page_cache_->Invalidate(request.page_id_);
+      }
+      ExtendDbFileSize((static_cast<int64_t>(request.page_id_) + 1) * PAGE_SIZE);
+      num_writes_ += 1;
+    } else if (page_cache_ != nullptr && page_cache_->ReadPage(request.page_id_, request.data_)) {
+      request.callback_.set_value(true);
+      continue;
+    }
+    to_submit.push_back(std::move(request));
   }
+  async_io_->Submit(&to_submit);
 }
 
 /**
@@ -209,10 +630,19 @@ bool DiskManager::GetFlushState() const { return flush_log_; }
 /**
  * Private helper function to get disk file size
  */
-int DiskManager::GetFileSize(const std::string &file_name) {
+int64_t DiskManager::GetFileSize(const std::string &file_name) {
   struct stat stat_buf;
   int rc = stat(file_name.c_str(), &stat_buf);
-  return rc == 0 ? static_cast<int>(stat_buf.st_size) : -1;
+  return rc == 0 ? static_cast<int64_t>(stat_buf.st_size) : -1;
+}
+
+/**
+ * Private helper function to grow the tracked db file size
+ */
+void DiskManager::ExtendDbFileSize(int64_t end) {
+  int64_t size = db_file_size_.load();
+  while (size < end && !db_file_size_.compare_exchange_weak(size, end)) {
+  }
 }
 
 }  // namespace bustub
@@ -0,0 +1,178 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// local_page_cache.cpp
+//
+// Identification: src/storage/disk/local_page_cache.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/disk/local_page_cache.h"
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <cstdio>
+#include <iterator>
+#include <limits>
+
+#include "common/exception.h"
+
+namespace bustub {
+
+static constexpr size_t NO_SLOT = std::numeric_limits<size_t>::max();
+
+LocalPageCache::LocalPageCache(const std::string &cache_file, size_t capacity, size_t admission_threshold)
+    : file_name_(cache_file), admission_threshold_(admission_threshold), slots_(capacity) {
+  BUSTUB_ASSERT(capacity > 0, "the local page cache needs at least one slot");
+  // 缓存文件里的内容重启之后不再可信，每次都从空文件开始
+  fd_ = open(file_name_.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+  if (fd_ < 0) {
+    throw Exception("can't open local page cache file");
+  }
+}
+
+LocalPageCache::~LocalPageCache() {
+  close(fd_);
+  remove(file_name_.c_str());
+}
+
+bool LocalPageCache::ReadPage(page_id_t page_id, char *page_data) {
+  size_t slot;
+  uint64_t version;
+  {
+    std::scoped_lock lk{latch_};
+    auto iter = page_slots_.find(page_id);
+    if (iter == page_slots_.end()) {
+      misses_++;
+      return false;
+    }
+    slot = iter->second;
+    version = slots_[slot].version_;
+    slots_[slot].referenced_ = true;
+  }
+  // 读文件时不持有latch_；读完再确认该slot没有在此期间被替换
+  bool read = pread(fd_, page_data, PAGE_SIZE, static_cast<off_t>(slot) * PAGE_SIZE) == PAGE_SIZE;
+  std::scoped_lock lk{latch_};
+  if (!read || slots_[slot].version_ != version) {
+    misses_++;
+    return false;
+  }
+  hits_++;
+  return true;
+}
+
+uint64_t LocalPageCache::BeginAdmit(page_id_t page_id) {
+  std::scoped_lock lk{latch_};
+  auto iter = page_slots_.find(page_id);
+  if (iter != page_slots_.end()) {
+    // 缓存里的副本仍然和数据库文件一致
+    slots_[iter->second].referenced_ = true;
+    return 0;
+  }
+  if (!ShouldAdmit(page_id)) {
+    return 0;
+  }
+  return Epoch(page_id).load() + 1;
+}
+
+void LocalPageCache::FinishAdmit(page_id_t page_id, const char *page_data, uint64_t ticket) {
+  if (ticket == 0) {
+    return;
+  }
+  size_t slot;
+  {
+    std::scoped_lock lk{latch_};
+    if (Epoch(page_id).load() + 1 != ticket || page_slots_.count(page_id) != 0) {
+      return;
+    }
+    slot = PickSlot();
+    if (slot == NO_SLOT) {
+      return;
+    }
+  }
+  // 写文件时不持有latch_；PickSlot已经把该slot标记为正在填充，不会被别人选中
+  bool written = pwrite(fd_, page_data, PAGE_SIZE, static_cast<off_t>(slot) * PAGE_SIZE) == PAGE_SIZE;
+  std::scoped_lock lk{latch_};
+  Slot &target = slots_[slot];
+  target.version_++;
+  // 写入期间该页面可能被修改写回（Invalidate），此时副本已经过期
+  if (!written || Epoch(page_id).load() + 1 != ticket || page_slots_.count(page_id) != 0) {
+    target.page_id_ = INVALID_PAGE_ID;
+    return;
+  }
+  target.page_id_ = page_id;
+  target.referenced_ = false;
+  page_slots_[page_id] = slot;
+  admissions_++;
+}
+
+void LocalPageCache::Invalidate(page_id_t page_id) {
+  // 先让进行中的FinishAdmit失效，再清掉已经缓存的副本
+  Epoch(page_id).fetch_add(1);
+  std::scoped_lock lk{latch_};
+  EvictLocked(page_id);
+}
+
+void LocalPageCache::EvictLocked(page_id_t page_id) {
+  auto iter = page_slots_.find(page_id);
+  if (iter == page_slots_.end()) {
+    return;
+  }
+  Slot &slot = slots_[iter->second];
+  slot.page_id_ = INVALID_PAGE_ID;
+  slot.version_ += 2;
+  slot.referenced_ = false;
+  page_slots_.erase(iter);
+}
+
+bool LocalPageCache::ShouldAdmit(page_id_t page_id) {
+  if (admission_threshold_ <= 1) {
+    return true;
+  }
+  auto iter = eviction_counts_.find(page_id);
+  if (iter == eviction_counts_.end()) {
+    // 只记住最近被替换出去的capacity个页面
+    if (eviction_history_.size() >= slots_.size()) {
+      eviction_counts_.erase(eviction_history_.front());
+      eviction_history_.pop_front();
+    }
+    eviction_history_.push_back(page_id);
+    iter = eviction_counts_.emplace(page_id, EvictionCount{0, std::prev(eviction_history_.end())}).first;
+  }
+  if (++iter->second.count_ < admission_threshold_) {
+    return false;
+  }
+  // 计数和历史一起删掉，之后再被替换出去时重新计数
+  eviction_history_.erase(iter->second.history_);
+  eviction_counts_.erase(iter);
+  return true;
+}
+
+size_t LocalPageCache::PickSlot() {
+  // 跳过正在填充的slot；转两圈还找不到就放弃这次准入
+  for (size_t i = 0; i < 2 * slots_.size(); ++i) {
+    size_t slot = clock_hand_;
+    clock_hand_ = (clock_hand_ + 1) % slots_.size();
+    Slot &candidate = slots_[slot];
+    if (candidate.version_ % 2 == 1) {
+      continue;
+    }
+    if (candidate.referenced_) {
+      candidate.referenced_ = false;
+      continue;
+    }
+    if (candidate.page_id_ != INVALID_PAGE_ID) {
+      EvictLocked(candidate.page_id_);
+    }
+    // 标记为正在填充，FinishAdmit写完之后再加一
+    candidate.version_++;
+    return slot;
+  }
+  return NO_SLOT;
+}
+
+}  // namespace bustub
@@ -16,8 +16,8 @@
 
 namespace bustub {
 
-TableIterator::TableIterator(TableHeap *table_heap, RID rid, Transaction *txn)
-    : table_heap_(table_heap), tuple_(new Tuple(rid)), txn_(txn) {
+TableIterator::TableIterator(TableHeap *table_heap, RID rid, Transaction *txn, BufferAccessStrategy *strategy)
+    : table_heap_(table_heap), tuple_(new Tuple(rid)), txn_(txn), strategy_(strategy) {
   if (rid.GetPageId() != INVALID_PAGE_ID) {
     table_heap_->GetTuple(tuple_->rid_, tuple_, txn_);
   }
@@ -35,19 +35,19 @@ Tuple *TableIterator::operator->() {
 
 TableIterator &TableIterator::operator++() {
   BufferPoolManager *buffer_pool_manager = table_heap_->buffer_pool_manager_;
-  auto cur_page = static_cast<TablePage *>(buffer_pool_manager->FetchPage(tuple_->rid_.GetPageId()));
-  cur_page->RLatch();
-  assert(cur_page != nullptr);  // all pages are pinned
+  auto cur_guard = buffer_pool_manager->FetchPageRead(tuple_->rid_.GetPageId(), strategy_);
+  assert(cur_guard.IsValid());  // all pages are pinned
+  auto cur_page = static_cast<TablePage *>(cur_guard.GetPage());
 
   RID next_tuple_rid;
   if (!cur_page->GetNextTupleRid(tuple_->rid_,
                                  &next_tuple_rid)) {  // end of this page
     while (cur_page->GetNextPageId() != INVALID_PAGE_ID) {
-      auto next_page = static_cast<TablePage *>(buffer_pool_manager->FetchPage(cur_page->GetNextPageId()));
-      cur_page->RUnlatch();
-      buffer_pool_manager->UnpinPage(cur_page->GetTablePageId(), false);
-      cur_page = next_page;
-      cur_page->RLatch();
+      // The next page is latched before the current one is released.
+      cur_guard = buffer_pool_manager->FetchPageRead(cur_page->GetNextPageId(), strategy_);
+      cur_page = static_cast<TablePage *>(cur_guard.GetPage());
+      // Read ahead one page, so that the next page is resident by the time we are done with this one.
+      buffer_pool_manager->PrefetchPage(cur_page->GetNextPageId());
       if (cur_page->GetFirstTupleRid(&next_tuple_rid)) {
         break;
       }
@@ -56,11 +56,9 @@ TableIterator &TableIterator::operator++() {
   tuple_->rid_ = next_tuple_rid;
 
   if (*this != table_heap_->End()) {
-    table_heap_->GetTuple(tuple_->rid_, tuple_, txn_);
+    // Copy the tuple out of the page we hold, rather than fetching and latching it again through the table heap.
+    cur_page->GetTuple(tuple_->rid_, tuple_, txn_, table_heap_->lock_manager_);
   }
-  // release until copy the tuple
-  cur_page->RUnlatch();
-  buffer_pool_manager->UnpinPage(cur_page->GetTablePageId(), false);
   return *this;
 }
 
@@ -11,9 +11,12 @@
 //===----------------------------------------------------------------------===//
 
 #include "buffer/buffer_pool_manager_instance.h"
+#include <chrono>  // NOLINT
 #include <cstdio>
 #include <random>
 #include <string>
+#include <thread>  // NOLINT
+#include <vector>
 #include "buffer/buffer_pool_manager.h"
 #include "gtest/gtest.h"
 
@@ -141,4 +144,777 @@ TEST(BufferPoolManagerInstanceTest, SampleTest) {
   delete disk_manager;
 }
 
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerInstanceTest, ConcurrentFetchTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 10;
+  const int num_pages = 30;
+  const int num_threads = 8;
+  const int num_rounds = 2000;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
+
+  // Scenario: write the page id into every page, so that readers can tell whether they got the right frame.
+  for (int i = 0; i < num_pages; ++i) {
+    page_id_t page_id_temp;
+    auto *page = bpm->NewPage(&page_id_temp);
+    ASSERT_NE(nullptr, page);
+    ASSERT_EQ(i, page_id_temp);
+    snprintf(page->GetData(), PAGE_SIZE, "page %d", i);
+    EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, true));
+  }
+
+  // Scenario: hits, misses and evictions race with each other. Every thread pins at most one page at a time, so a
+  // fetch can never fail.
+  std::vector<std::thread> threads;
+  for (int tid = 0; tid < num_threads; ++tid) {
+    threads.emplace_back([bpm, tid, num_pages, num_rounds]() {
+      std::default_random_engine rng(tid);
+      // Skew towards a few hot pages so that both the hit and the miss path are exercised.
+      std::uniform_int_distribution<int> hot_dist(0, 3);
+      std::uniform_int_distribution<int> cold_dist(0, num_pages - 1);
+      char expected[PAGE_SIZE];
+      for (int round = 0; round < num_rounds; ++round) {
+        page_id_t page_id = round % 2 == 0 ? hot_dist(rng) : cold_dist(rng);
+        auto *page = bpm->FetchPage(page_id);
+        ASSERT_NE(nullptr, page);
+        snprintf(expected, PAGE_SIZE, "page %d", page_id);
+        EXPECT_EQ(0, strcmp(page->GetData(), expected));
+        EXPECT_EQ(true, bpm->UnpinPage(page_id, false));
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+
+  // Scenario: all pins were released, so every page can be deleted and unpinning again must fail.
+  for (int i = 0; i < num_pages; ++i) {
+    EXPECT_EQ(false, bpm->UnpinPage(i, false));
+    EXPECT_EQ(true, bpm->DeletePage(i));
+  }
+
+  disk_manager->ShutDown();
+  remove("test.db");
+  remove("test.fsm");
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerInstanceTest, ConcurrentHitTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 10;
+  const int num_threads = 8;
+  const int num_rounds = 20000;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
+  for (int i = 0; i < num_threads; ++i) {
+    page_id_t page_id_temp;
+    ASSERT_NE(nullptr, bpm->NewPage(&page_id_temp));
+    EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, false));
+  }
+
+  // Scenario: every thread keeps fetching its own resident page. Hits take neither the instance latch nor a latch of
+  // the replacer, so no fetch ever waits for the instance latch and every fetch is a hit.
+  BufferPoolStats before = bpm->GetStats();
+  std::vector<std::thread> threads;
+  for (int tid = 0; tid < num_threads; ++tid) {
+    threads.emplace_back([bpm, tid, num_rounds]() {
+      for (int round = 0; round < num_rounds; ++round) {
+        ASSERT_NE(nullptr, bpm->FetchPage(tid));
+        EXPECT_EQ(true, bpm->UnpinPage(tid, false));
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  BufferPoolStats after = bpm->GetStats();
+  EXPECT_EQ(before.hits_ + num_threads * num_rounds, after.hits_);
+  EXPECT_EQ(before.misses_, after.misses_);
+  EXPECT_EQ(before.latch_waits_, after.latch_waits_);
+
+  // Scenario: all pins were released, so every page can be deleted.
+  for (int i = 0; i < num_threads; ++i) {
+    EXPECT_EQ(true, bpm->DeletePage(i));
+  }
+
+  disk_manager->ShutDown();
+  remove("test.db");
+  remove("test.fsm");
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerInstanceTest, ConcurrentDirtyEvictionTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 10;
+  const int num_threads = 8;
+  const int pages_per_thread = 5;
+  const int num_pages = num_threads * pages_per_thread;
+  const int num_rounds = 1000;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
+
+  for (int i = 0; i < num_pages; ++i) {
+    page_id_t page_id_temp;
+    auto *page = bpm->NewPage(&page_id_temp);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), PAGE_SIZE, "page %d version %d", i, 0);
+    EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, true));
+  }
+
+  // Scenario: every thread owns some pages and keeps bumping their version, while also reading the pages of the
+  // others. Dirty victims are written back outside the instance latch, so a page that is fetched again right after
+  // its eviction must still come back with the latest version.
+  std::vector<std::thread> threads;
+  for (int tid = 0; tid < num_threads; ++tid) {
+    threads.emplace_back([bpm, tid, num_pages, num_rounds]() {
+      std::default_random_engine rng(tid);
+      std::uniform_int_distribution<int> own_dist(0, pages_per_thread - 1);
+      std::uniform_int_distribution<int> any_dist(0, num_pages - 1);
+      std::vector<int> versions(pages_per_thread, 0);
+      char expected[PAGE_SIZE];
+      for (int round = 0; round < num_rounds; ++round) {
+        if (round % 2 == 0) {
+          int slot = own_dist(rng);
+          page_id_t page_id = slot * num_threads + tid;
+          auto *page = bpm->FetchPage(page_id);
+          ASSERT_NE(nullptr, page);
+          page->WLatch();
+          snprintf(expected, PAGE_SIZE, "page %d version %d", page_id, versions[slot]);
+          EXPECT_EQ(0, strcmp(page->GetData(), expected));
+          snprintf(page->GetData(), PAGE_SIZE, "page %d version %d", page_id, ++versions[slot]);
+          page->WUnlatch();
+          EXPECT_EQ(true, bpm->UnpinPage(page_id, true));
+        } else {
+          page_id_t page_id = any_dist(rng);
+          auto *page = bpm->FetchPage(page_id);
+          ASSERT_NE(nullptr, page);
+          page->RLatch();
+          snprintf(expected, PAGE_SIZE, "page %d version", page_id);
+          EXPECT_EQ(0, strncmp(page->GetData(), expected, strlen(expected)));
+          page->RUnlatch();
+          EXPECT_EQ(true, bpm->UnpinPage(page_id, false));
+        }
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+
+  delete bpm;
+  disk_manager->ShutDown();
+  remove("test.db");
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerInstanceTest, ReplacerPolicyTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 10;
+  const int num_pages = 25;
+
+  for (auto replacer_type : {ReplacerType::LRU, ReplacerType::CLOCK}) {
+    auto *disk_manager = new DiskManager(db_name);
+    BufferPoolOptions options;
+    options.replacer_type_ = replacer_type;
+    auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager, nullptr, options);
+
+    // Scenario: create more pages than fit in the pool, so that the replacer has to evict dirty pages.
+    for (int i = 0; i < num_pages; ++i) {
+      page_id_t page_id_temp;
+      auto *page = bpm->NewPage(&page_id_temp);
+      ASSERT_NE(nullptr, page);
+      snprintf(page->GetData(), PAGE_SIZE, "page %d", i);
+      EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, true));
+    }
+
+    // Scenario: pinning the whole pool leaves the replacer with nothing to evict.
+    for (int i = 0; i < static_cast<int>(buffer_pool_size); ++i) {
+      EXPECT_NE(nullptr, bpm->FetchPage(i));
+    }
+    EXPECT_EQ(nullptr, bpm->FetchPage(num_pages - 1));
+    for (int i = 0; i < static_cast<int>(buffer_pool_size); ++i) {
+      EXPECT_EQ(true, bpm->UnpinPage(i, false));
+    }
+
+    // Scenario: every page reads back what was written before it was evicted.
+    char expected[PAGE_SIZE];
+    for (int i = num_pages - 1; i >= 0; --i) {
+      auto *page = bpm->FetchPage(i);
+      ASSERT_NE(nullptr, page);
+      snprintf(expected, PAGE_SIZE, "page %d", i);
+      EXPECT_EQ(0, strcmp(page->GetData(), expected));
+      EXPECT_EQ(true, bpm->UnpinPage(i, false));
+    }
+
+    disk_manager->ShutDown();
+    remove("test.db");
+
+    delete bpm;
+    delete disk_manager;
+  }
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerInstanceTest, AccessStrategyTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 64;
+  const int num_pages = 200;
+  const int num_hot_pages = 32;
+
+  for (bool use_strategy : {true, false}) {
+    auto *disk_manager = new DiskManager(db_name);
+    auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
+
+    for (int i = 0; i < num_pages; ++i) {
+      page_id_t page_id_temp;
+      auto *page = bpm->NewPage(&page_id_temp);
+      ASSERT_NE(nullptr, page);
+      snprintf(page->GetData(), PAGE_SIZE, "page %d", i);
+      EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, true));
+    }
+    bpm->FlushAllPages();
+
+    // Scenario: the hot pages are dirtied, so evicting any of them shows up as a disk write.
+    for (int i = 0; i < num_hot_pages; ++i) {
+      ASSERT_NE(nullptr, bpm->FetchPage(i));
+      EXPECT_EQ(true, bpm->UnpinPage(i, true));
+    }
+    int num_writes = disk_manager->GetNumWrites();
+
+    // Scenario: a scan over the rest of the table reads every page correctly.
+    BufferAccessStrategy strategy(AccessStrategyType::BULK_READ, 8);
+    char expected[PAGE_SIZE];
+    for (int i = num_hot_pages; i < num_pages; ++i) {
+      auto *page = bpm->FetchPageWithStrategy(i, use_strategy ? &strategy : nullptr);
+      ASSERT_NE(nullptr, page);
+      snprintf(expected, PAGE_SIZE, "page %d", i);
+      EXPECT_EQ(0, strcmp(page->GetData(), expected));
+      EXPECT_EQ(true, bpm->UnpinPage(i, false));
+    }
+
+    // Scenario: only the scan without a strategy pushes the hot pages out of the pool.
+    if (use_strategy) {
+      EXPECT_EQ(num_writes, disk_manager->GetNumWrites());
+    } else {
+      EXPECT_LT(num_writes, disk_manager->GetNumWrites());
+    }
+
+    disk_manager->ShutDown();
+    remove("test.db");
+
+    delete bpm;
+    delete disk_manager;
+  }
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerInstanceTest, LatchCouplingScanTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 10;
+  const int num_pages = 30;
+  const int num_hot_pages = 6;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
+
+  for (int i = 0; i < num_pages; ++i) {
+    page_id_t page_id_temp;
+    auto *page = bpm->NewPage(&page_id_temp);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), PAGE_SIZE, "page %d", i);
+    EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, true));
+  }
+  bpm->FlushAllPages();
+
+  // Scenario: the hot pages are dirtied, so evicting any of them shows up as a disk write.
+  for (int i = 0; i < num_hot_pages; ++i) {
+    ASSERT_NE(nullptr, bpm->FetchPage(i));
+    EXPECT_EQ(true, bpm->UnpinPage(i, true));
+  }
+  int num_writes = disk_manager->GetNumWrites();
+
+  // Scenario: a scan with the default ring latches the next page before releasing the current one, as TableIterator
+  // does, so two of its pages are pinned at any time. The ring still recycles its own frames.
+  BufferAccessStrategy strategy(AccessStrategyType::BULK_READ);
+  char expected[PAGE_SIZE];
+  auto guard = bpm->FetchPageRead(num_hot_pages, &strategy);
+  for (int i = num_hot_pages; i < num_pages; ++i) {
+    ASSERT_TRUE(guard.IsValid());
+    snprintf(expected, PAGE_SIZE, "page %d", i);
+    EXPECT_EQ(0, strcmp(guard.GetData(), expected));
+    if (i + 1 < num_pages) {
+      guard = bpm->FetchPageRead(i + 1, &strategy);
+    }
+  }
+  guard.Drop();
+
+  // Scenario: the scan only evicted ring frames, so the hot pages are neither written back nor read again.
+  EXPECT_EQ(num_writes, disk_manager->GetNumWrites());
+  BufferPoolStats before = bpm->GetStats();
+  for (int i = 0; i < num_hot_pages; ++i) {
+    ASSERT_NE(nullptr, bpm->FetchPage(i));
+    EXPECT_EQ(true, bpm->UnpinPage(i, false));
+  }
+  EXPECT_EQ(before.misses_, bpm->GetStats().misses_);
+
+  disk_manager->ShutDown();
+  remove("test.db");
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerInstanceTest, PrefetchTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 10;
+  const int num_pages = 20;
+
+  auto *disk_manager = new DiskManager(db_name);
+  BufferPoolOptions options;
+  options.prefetch_threads_ = 1;
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager, nullptr, options);
+
+  for (int i = 0; i < num_pages; ++i) {
+    page_id_t page_id_temp;
+    auto *page = bpm->NewPage(&page_id_temp);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), PAGE_SIZE, "page %d", i);
+    EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, true));
+  }
+
+  // Scenario: a resident dirty page is not overwritten by a prefetch of the same page.
+  auto *page = bpm->FetchPage(num_pages - 1);
+  ASSERT_NE(nullptr, page);
+  snprintf(page->GetData(), PAGE_SIZE, "changed");
+  EXPECT_EQ(true, bpm->UnpinPage(num_pages - 1, true));
+  bpm->PrefetchPage(num_pages - 1);
+
+  // Scenario: prefetched pages read back what was written before they were evicted.
+  bpm->PrefetchPages({0, 1, 2, 3, 4});
+  char expected[PAGE_SIZE];
+  for (int i = 0; i < 5; ++i) {
+    page = bpm->FetchPage(i);
+    ASSERT_NE(nullptr, page);
+    snprintf(expected, PAGE_SIZE, "page %d", i);
+    EXPECT_EQ(0, strcmp(page->GetData(), expected));
+    EXPECT_EQ(true, bpm->UnpinPage(i, false));
+  }
+  page = bpm->FetchPage(num_pages - 1);
+  ASSERT_NE(nullptr, page);
+  EXPECT_EQ(0, strcmp(page->GetData(), "changed"));
+  EXPECT_EQ(true, bpm->UnpinPage(num_pages - 1, false));
+
+  // Scenario: a prefetch never steals a pinned frame.
+  std::vector<Page *> pinned;
+  for (int i = 0; i < static_cast<int>(buffer_pool_size); ++i) {
+    pinned.push_back(bpm->FetchPage(num_pages - 1 - i));
+    ASSERT_NE(nullptr, pinned.back());
+  }
+  bpm->PrefetchPages({0, 1, 2});
+  std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  for (int i = 0; i < static_cast<int>(buffer_pool_size); ++i) {
+    EXPECT_EQ(num_pages - 1 - i, pinned[i]->GetPageId());
+    EXPECT_EQ(true, bpm->UnpinPage(num_pages - 1 - i, false));
+  }
+
+  disk_manager->ShutDown();
+  remove("test.db");
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerInstanceTest, BackgroundWriterTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 10;
+  const int num_pages = 20;
+
+  auto *disk_manager = new DiskManager(db_name);
+  BufferPoolOptions options;
+  options.bg_writer_clean_ratio_ = 1.0;
+  options.bg_writer_interval_ = std::chrono::milliseconds(1);
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager, nullptr, options);
+
+  for (int i = 0; i < num_pages; ++i) {
+    page_id_t page_id_temp;
+    auto *page = bpm->NewPage(&page_id_temp);
+    ASSERT_NE(nullptr, page);
+    page->WLatch();
+    snprintf(page->GetData(), PAGE_SIZE, "page %d", i);
+    page->WUnlatch();
+    EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, true));
+  }
+
+  // Scenario: with every candidate kept clean, the writer eventually writes back all resident pages.
+  for (int retry = 0; retry < 1000 && bpm->GetBackgroundWrites() < buffer_pool_size; ++retry) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  EXPECT_LE(buffer_pool_size, bpm->GetBackgroundWrites());
+
+  // Scenario: evicting clean pages needs no synchronous write, and the written pages read back correctly.
+  size_t sync_writes = bpm->GetSyncEvictionWrites();
+  char expected[PAGE_SIZE];
+  for (int i = 0; i < num_pages - static_cast<int>(buffer_pool_size); ++i) {
+    auto *page = bpm->FetchPage(i);
+    ASSERT_NE(nullptr, page);
+    page->RLatch();
+    snprintf(expected, PAGE_SIZE, "page %d", i);
+    EXPECT_EQ(0, strcmp(page->GetData(), expected));
+    page->RUnlatch();
+    EXPECT_EQ(true, bpm->UnpinPage(i, false));
+  }
+  EXPECT_EQ(sync_writes, bpm->GetSyncEvictionWrites());
+
+  delete bpm;
+  disk_manager->ShutDown();
+  remove("test.db");
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerInstanceTest, StatsTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 3;
+  const int num_pages = 5;
+
+  auto *disk_manager = new DiskManager(db_name);
+  BufferPoolOptions options;
+  options.stats_sample_interval_ = 1;
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager, nullptr, options);
+
+  // Scenario: new pages are neither hits nor misses, but the pages they push out are dirty evictions.
+  for (int i = 0; i < num_pages; ++i) {
+    page_id_t page_id_temp;
+    ASSERT_NE(nullptr, bpm->NewPage(&page_id_temp));
+    EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, true));
+  }
+  auto stats = bpm->GetStats();
+  EXPECT_EQ(0, stats.hits_);
+  EXPECT_EQ(0, stats.misses_);
+  EXPECT_EQ(2, stats.evictions_);
+  EXPECT_EQ(2, stats.sync_writes_);
+  EXPECT_EQ(0, stats.HitRatio());
+
+  // Scenario: fetches of resident pages are hits, other fetches are misses that evict the least recently used page.
+  for (int i = 0; i < 3; ++i) {
+    ASSERT_NE(nullptr, bpm->FetchPage(4));
+    EXPECT_EQ(true, bpm->UnpinPage(4, false));
+  }
+  ASSERT_NE(nullptr, bpm->FetchPage(0));
+  EXPECT_EQ(true, bpm->UnpinPage(0, false));
+  stats = bpm->GetStats();
+  EXPECT_EQ(3, stats.hits_);
+  EXPECT_EQ(1, stats.misses_);
+  EXPECT_EQ(3, stats.evictions_);
+  EXPECT_EQ(3, stats.sync_writes_);
+  EXPECT_EQ(0.75, stats.HitRatio());
+
+  // Scenario: the heat histogram counts the evicted pages and the resident pages by their number of fetches.
+  EXPECT_EQ(4, stats.heat_histogram_[0]);  // pages 0, 1 and 2 evicted unfetched, page 3 resident unfetched
+  EXPECT_EQ(1, stats.heat_histogram_[BufferPoolStats::HeatBucket(1)]);  // page 0
+  EXPECT_EQ(1, stats.heat_histogram_[BufferPoolStats::HeatBucket(3)]);  // page 4
+  EXPECT_EQ(2, BufferPoolStats::HeatBucket(3));
+
+  delete bpm;
+  disk_manager->ShutDown();
+  remove("test.db");
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerInstanceTest, FlushAllTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 8;
+  const int num_pages = 8;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
+  for (int i = 0; i < num_pages; ++i) {
+    page_id_t page_id_temp;
+    auto *page = bpm->NewPage(&page_id_temp);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), PAGE_SIZE, "page %d", i);
+    EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, true));
+  }
+
+  // Scenario: every dirty page is written once, and the pages are clean and unpinned afterwards.
+  bpm->FlushAllPages();
+  EXPECT_EQ(num_pages, disk_manager->GetNumWrites());
+  for (int i = 0; i < num_pages; ++i) {
+    auto *page = bpm->FetchPage(i);
+    ASSERT_NE(nullptr, page);
+    EXPECT_FALSE(page->IsDirty());
+    EXPECT_EQ(1, page->GetPinCount());
+    EXPECT_EQ(true, bpm->UnpinPage(i, false));
+  }
+
+  // Scenario: only the pages dirtied since the last flush are written again.
+  auto *page = bpm->FetchPage(5);
+  ASSERT_NE(nullptr, page);
+  snprintf(page->GetData(), PAGE_SIZE, "page 5 updated");
+  EXPECT_EQ(true, bpm->UnpinPage(5, true));
+  ASSERT_NE(nullptr, bpm->FetchPage(2));
+  EXPECT_EQ(true, bpm->UnpinPage(2, true));
+  bpm->FlushAllPages();
+  EXPECT_EQ(num_pages + 2, disk_manager->GetNumWrites());
+  bpm->FlushAllPages();
+  EXPECT_EQ(num_pages + 2, disk_manager->GetNumWrites());
+
+  // Scenario: the file holds the latest content of every page.
+  char data[PAGE_SIZE];
+  for (int i = 0; i < num_pages; ++i) {
+    char expected[PAGE_SIZE];
+    snprintf(expected, PAGE_SIZE, i == 5 ? "page %d updated" : "page %d", i);
+    disk_manager->ReadPage(i, data);
+    EXPECT_EQ(0, strcmp(data, expected));
+  }
+
+  delete bpm;
+  disk_manager->ShutDown();
+  remove("test.db");
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerInstanceTest, FlushKeepsFramesAvailableTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 4;
+  const int num_pages = 5;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
+  std::vector<Page *> pages;
+  for (int i = 0; i < num_pages; ++i) {
+    page_id_t page_id_temp;
+    auto *page = bpm->NewPage(&page_id_temp);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), PAGE_SIZE, "page %d", i);
+    EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, true));
+    pages.push_back(page);
+  }
+
+  // Scenario: while a flush waits for the latch of page 4, the pages it has copied out are not pinned, so a miss on
+  // page 0 still finds a frame in a pool full of dirty pages.
+  auto *latched = bpm->FetchPage(4);
+  ASSERT_NE(nullptr, latched);
+  latched->WLatch();
+  std::thread flusher([bpm] { bpm->FlushAllPages(); });
+  while (pages[3]->IsDirty()) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  auto *page = bpm->FetchPage(0);
+  ASSERT_NE(nullptr, page);
+  EXPECT_EQ(0, strcmp(page->GetData(), "page 0"));
+  EXPECT_EQ(true, bpm->UnpinPage(0, false));
+  snprintf(latched->GetData(), PAGE_SIZE, "page 4 updated");
+  latched->WUnlatch();
+  EXPECT_EQ(true, bpm->UnpinPage(4, true));
+  flusher.join();
+
+  // Scenario: the pages copied out before the stall are on disk, and the latched page is written once released.
+  char data[PAGE_SIZE];
+  for (int i = 1; i < num_pages; ++i) {
+    char expected[PAGE_SIZE];
+    snprintf(expected, PAGE_SIZE, i == 4 ? "page %d updated" : "page %d", i);
+    disk_manager->ReadPage(i, data);
+    EXPECT_EQ(0, strcmp(data, expected));
+  }
+
+  delete bpm;
+  disk_manager->ShutDown();
+  remove("test.db");
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerInstanceTest, PageReuseTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 4;
+  const int num_pages = 8;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
+  for (int i = 0; i < num_pages; ++i) {
+    page_id_t page_id_temp;
+    ASSERT_NE(nullptr, bpm->NewPage(&page_id_temp));
+    EXPECT_EQ(i, page_id_temp);
+    EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, true));
+  }
+  bpm->FlushAllPages();
+
+  // Scenario: deleted pages, in the buffer pool or not, are handed out again by NewPage, the lowest id first.
+  EXPECT_EQ(true, bpm->DeletePage(5));
+  EXPECT_EQ(true, bpm->DeletePage(1));
+  EXPECT_EQ(2, disk_manager->GetNumFreePages());
+  page_id_t page_id_temp;
+  ASSERT_NE(nullptr, bpm->NewPage(&page_id_temp));
+  EXPECT_EQ(1, page_id_temp);
+  EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, true));
+  ASSERT_NE(nullptr, bpm->NewPage(&page_id_temp));
+  EXPECT_EQ(5, page_id_temp);
+  EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, true));
+  ASSERT_NE(nullptr, bpm->NewPage(&page_id_temp));
+  EXPECT_EQ(num_pages, page_id_temp);
+  EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, false));
+  // Scenario: a pinned page cannot be deleted and is not freed; an id this instance never allocated is not freed.
+  ASSERT_NE(nullptr, bpm->FetchPage(3));
+  EXPECT_EQ(false, bpm->DeletePage(3));
+  EXPECT_EQ(true, bpm->UnpinPage(3, false));
+  EXPECT_EQ(true, bpm->DeletePage(100));
+  EXPECT_EQ(0, disk_manager->GetNumFreePages());
+
+  // Scenario: freed pages at the end of the file are truncated, and a new buffer pool allocates after the file's end.
+  EXPECT_EQ(true, bpm->DeletePage(6));
+  EXPECT_EQ(true, bpm->DeletePage(7));
+  bpm->FlushAllPages();
+  EXPECT_EQ(2, disk_manager->TruncateFreePages());
+  EXPECT_EQ(6 * PAGE_SIZE, disk_manager->GetDbFileSize());
+  delete bpm;
+  bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
+  ASSERT_NE(nullptr, bpm->NewPage(&page_id_temp));
+  EXPECT_EQ(6, page_id_temp);
+  EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, false));
+
+  delete bpm;
+  disk_manager->ShutDown();
+  remove("test.db");
+  remove("test.fsm");
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerInstanceTest, ReusedPageIsZeroedTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 2;
+  // Scenario: with and without a second-tier page cache, which may hold a copy of the deleted page.
+  for (bool with_cache : {false, true}) {
+    auto *disk_manager = new DiskManager(db_name);
+    LocalPageCache cache("test_cache.tmp", 8, 1);
+    if (with_cache) {
+      disk_manager->SetPageCache(&cache);
+    }
+    auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
+
+    page_id_t page_id_temp;
+    auto *page = bpm->NewPage(&page_id_temp);
+    ASSERT_NE(nullptr, page);
+    ASSERT_EQ(0, page_id_temp);
+    snprintf(page->GetData(), PAGE_SIZE, "SECRET old content");
+    EXPECT_EQ(true, bpm->UnpinPage(0, true));
+    bpm->FlushAllPages();
+    // Evict the clean page, which offers it to the page cache.
+    for (int i = 1; i <= static_cast<int>(buffer_pool_size); ++i) {
+      ASSERT_NE(nullptr, bpm->NewPage(&page_id_temp));
+      EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, false));
+    }
+    EXPECT_EQ(true, bpm->DeletePage(0));
+
+    // Scenario: the reused page is unpinned clean and evicted, and fetching it again must not bring the old bytes back.
+    page = bpm->NewPage(&page_id_temp);
+    ASSERT_NE(nullptr, page);
+    ASSERT_EQ(0, page_id_temp);
+    EXPECT_EQ(true, bpm->UnpinPage(0, false));
+    for (int i = 1; i <= static_cast<int>(buffer_pool_size); ++i) {
+      ASSERT_NE(nullptr, bpm->FetchPage(i));
+      EXPECT_EQ(true, bpm->UnpinPage(i, false));
+    }
+    page = bpm->FetchPage(0);
+    ASSERT_NE(nullptr, page);
+    char zeroes[PAGE_SIZE] = {0};
+    EXPECT_EQ(0, memcmp(page->GetData(), zeroes, PAGE_SIZE));
+    EXPECT_EQ(true, bpm->UnpinPage(0, false));
+
+    delete bpm;
+    disk_manager->ShutDown();
+    delete disk_manager;
+    remove("test.db");
+    remove("test.fsm");
+    remove("test_cache.tmp");
+  }
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerInstanceTest, ResizeTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 10;
+  const size_t max_pool_size = 20;
+
+  auto *disk_manager = new DiskManager(db_name);
+  BufferPoolOptions options;
+  options.max_pool_size_ = max_pool_size;
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager, nullptr, options);
+  EXPECT_EQ(max_pool_size, bpm->GetMaxPoolSize());
+  EXPECT_EQ(false, bpm->Resize(max_pool_size + 1));
+  EXPECT_EQ(false, bpm->Resize(0));
+
+  // Scenario: after growing, the new frames can hold pages.
+  EXPECT_EQ(true, bpm->Resize(max_pool_size));
+  EXPECT_EQ(max_pool_size, bpm->GetPoolSize());
+  std::vector<Page *> pages;
+  for (int i = 0; i < static_cast<int>(max_pool_size); ++i) {
+    page_id_t page_id_temp;
+    pages.push_back(bpm->NewPage(&page_id_temp));
+    ASSERT_NE(nullptr, pages.back());
+    snprintf(pages.back()->GetData(), PAGE_SIZE, "page %d", i);
+  }
+  page_id_t page_id_temp;
+  EXPECT_EQ(nullptr, bpm->NewPage(&page_id_temp));
+
+  // Scenario: a shrink gives up while the pages it has to evict stay pinned, and pinned pages do not move.
+  EXPECT_EQ(false, bpm->Resize(5, std::chrono::milliseconds(10)));
+  EXPECT_EQ(max_pool_size, bpm->GetPoolSize());
+  for (int i = 0; i < static_cast<int>(max_pool_size); ++i) {
+    EXPECT_EQ(i, pages[i]->GetPageId());
+    EXPECT_EQ(true, bpm->UnpinPage(i, true));
+  }
+
+  // Scenario: once the pages are unpinned, the shrink evicts them and only the remaining frames can be pinned.
+  EXPECT_EQ(true, bpm->Resize(5));
+  EXPECT_EQ(5, bpm->GetPoolSize());
+  for (int i = 0; i < 5; ++i) {
+    EXPECT_NE(nullptr, bpm->FetchPage(i));
+  }
+  EXPECT_EQ(nullptr, bpm->FetchPage(5));
+  for (int i = 0; i < 5; ++i) {
+    EXPECT_EQ(true, bpm->UnpinPage(i, false));
+  }
+
+  // Scenario: every page written before the shrink reads back, with a shrink waiting for a pinned page meanwhile.
+  auto *pinned = bpm->FetchPage(0);
+  ASSERT_NE(nullptr, pinned);
+  std::thread resizer([bpm] { EXPECT_EQ(true, bpm->Resize(2)); });
+  std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  EXPECT_EQ(true, bpm->UnpinPage(0, false));
+  resizer.join();
+  EXPECT_EQ(2, bpm->GetPoolSize());
+  char expected[PAGE_SIZE];
+  for (int i = 0; i < static_cast<int>(max_pool_size); ++i) {
+    auto *page = bpm->FetchPage(i);
+    ASSERT_NE(nullptr, page);
+    snprintf(expected, PAGE_SIZE, "page %d", i);
+    EXPECT_EQ(0, strcmp(page->GetData(), expected));
+    EXPECT_EQ(true, bpm->UnpinPage(i, false));
+  }
+  EXPECT_EQ(true, bpm->Resize(buffer_pool_size));
+
+  disk_manager->ShutDown();
+  remove("test.db");
+
+  delete bpm;
+  delete disk_manager;
+}
+
 }  // namespace bustub
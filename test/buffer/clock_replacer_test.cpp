@@ -19,7 +19,7 @@
 
 namespace bustub {
 
-TEST(ClockReplacerTest, DISABLED_SampleTest) {
+TEST(ClockReplacerTest, SampleTest) {
   ClockReplacer clock_replacer(7);
 
   // Scenario: unpin six elements, i.e. add them to the replacer.
@@ -59,4 +59,32 @@ TEST(ClockReplacerTest, DISABLED_SampleTest) {
   EXPECT_EQ(4, value);
 }
 
+TEST(ClockReplacerTest, PeekVictimsTest) {
+  ClockReplacer clock_replacer(7);
+  for (int i = 1; i <= 4; ++i) {
+    clock_replacer.Unpin(i);
+  }
+  int value;
+  clock_replacer.Victim(&value);
+  EXPECT_EQ(1, value);
+
+  // Scenario: the first sweep cleared the reference bits of 2, 3 and 4. Unpinning 5 gives it a reference bit, and
+  // unpinning 2 again does not.
+  clock_replacer.Unpin(5);
+  clock_replacer.Unpin(2);
+  std::vector<frame_id_t> frames;
+  clock_replacer.PeekVictims(3, &frames);
+  EXPECT_EQ((std::vector<frame_id_t>{2, 3, 4}), frames);
+  EXPECT_EQ(4, clock_replacer.Size());
+
+  // Scenario: peeking does not move the clock hand.
+  frames.clear();
+  clock_replacer.PeekVictims(10, &frames);
+  EXPECT_EQ((std::vector<frame_id_t>{2, 3, 4, 5}), frames);
+  for (frame_id_t expected : frames) {
+    clock_replacer.Victim(&value);
+    EXPECT_EQ(expected, value);
+  }
+}
+
 }  // namespace bustub
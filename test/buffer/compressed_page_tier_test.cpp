@@ -0,0 +1,140 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// compressed_page_tier_test.cpp
+//
+// Identification: test/buffer/compressed_page_tier_test.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/compressed_page_tier.h"
+
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <vector>
+
+#include "buffer/buffer_pool_manager_instance.h"
+#include "common/util/page_codec.h"
+#include "gtest/gtest.h"
+
+namespace bustub {
+
+// NOLINTNEXTLINE
+TEST(CompressedPageTierTest, CodecTest) {
+  std::vector<char> compressed(PageCodec::MaxCompressedSize());
+  char page[PAGE_SIZE] = {0};
+  char out[PAGE_SIZE];
+
+  // Scenario: a mostly empty page with some repeated content shrinks a lot and round-trips.
+  for (int i = 0; i < 100; ++i) {
+    snprintf(page + i * 12, PAGE_SIZE - i * 12, "tuple %05d", i % 7);
+  }
+  size_t size = PageCodec::Compress(page, compressed.data(), compressed.size());
+  ASSERT_NE(0, size);
+  EXPECT_LT(size, PAGE_SIZE / 4);
+  ASSERT_TRUE(PageCodec::Decompress(compressed.data(), size, out));
+  EXPECT_EQ(0, memcmp(page, out, PAGE_SIZE));
+
+  // Scenario: random data round-trips given enough room, and is reported as not fitting in less than a page.
+  std::mt19937 rng(42);
+  for (char &c : page) {
+    c = static_cast<char>(rng());
+  }
+  size = PageCodec::Compress(page, compressed.data(), compressed.size());
+  ASSERT_NE(0, size);
+  ASSERT_TRUE(PageCodec::Decompress(compressed.data(), size, out));
+  EXPECT_EQ(0, memcmp(page, out, PAGE_SIZE));
+  EXPECT_EQ(0, PageCodec::Compress(page, compressed.data(), PAGE_SIZE / 2));
+
+  // Scenario: truncated input is rejected instead of producing a partial page.
+  EXPECT_FALSE(PageCodec::Decompress(compressed.data(), size / 2, out));
+}
+
+// NOLINTNEXTLINE
+TEST(CompressedPageTierTest, BudgetTest) {
+  char page[PAGE_SIZE] = {0};
+  char out[PAGE_SIZE];
+  std::vector<char> compressed(PageCodec::MaxCompressedSize());
+  snprintf(page, PAGE_SIZE, "page");
+  size_t entry_size = PageCodec::Compress(page, compressed.data(), compressed.size());
+  CompressedPageTier tier(3 * entry_size);
+
+  // Scenario: the tier holds as many pages as fit in its budget and drops the oldest ones beyond that.
+  for (page_id_t page_id = 0; page_id < 5; ++page_id) {
+    EXPECT_TRUE(tier.Put(page_id, page));
+  }
+  EXPECT_EQ(3, tier.GetSize());
+  EXPECT_EQ(3 * entry_size, tier.GetBytesUsed());
+  EXPECT_EQ(2, tier.GetBudgetEvictions());
+  EXPECT_FALSE(tier.Take(0, out));
+  EXPECT_FALSE(tier.Take(1, out));
+
+  // Scenario: Take removes the page, since it now lives in the buffer pool.
+  ASSERT_TRUE(tier.Take(2, out));
+  EXPECT_EQ(0, strcmp(out, "page"));
+  EXPECT_FALSE(tier.Take(2, out));
+  tier.Erase(3);
+  EXPECT_EQ(1, tier.GetSize());
+
+  // Scenario: pages that do not compress well are not kept.
+  std::mt19937 rng(42);
+  for (char &c : page) {
+    c = static_cast<char>(rng());
+  }
+  EXPECT_FALSE(tier.Put(10, page));
+  EXPECT_EQ(1, tier.GetRejected());
+}
+
+// NOLINTNEXTLINE
+TEST(CompressedPageTierTest, BufferPoolTest) {
+  const size_t buffer_pool_size = 2;
+  const int num_pages = 8;
+  remove("test.db");
+  auto *disk_manager = new DiskManager("test.db");
+  BufferPoolOptions options;
+  options.compressed_tier_bytes_ = num_pages * PAGE_SIZE / 4;
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager, nullptr, options);
+  CompressedPageTier *tier = bpm->GetCompressedTier();
+  ASSERT_NE(nullptr, tier);
+
+  for (int i = 0; i < num_pages; ++i) {
+    page_id_t page_id_temp;
+    auto *page = bpm->NewPage(&page_id_temp);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), PAGE_SIZE, "page %d", i);
+    EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, true));
+  }
+
+  // Scenario: evicted pages, clean or written back, are fetched back from the tier with their latest content.
+  for (int round = 0; round < 2; ++round) {
+    for (int i = 0; i < num_pages; ++i) {
+      auto *page = bpm->FetchPage(i);
+      ASSERT_NE(nullptr, page);
+      char expected[PAGE_SIZE];
+      snprintf(expected, PAGE_SIZE, round == 0 ? "page %d" : "page %d updated", i);
+      EXPECT_EQ(0, strcmp(page->GetData(), expected));
+      if (round == 0) {
+        snprintf(page->GetData(), PAGE_SIZE, "page %d updated", i);
+      }
+      EXPECT_EQ(true, bpm->UnpinPage(i, round == 0));
+    }
+  }
+  EXPECT_EQ(2 * num_pages, tier->GetHits());
+  EXPECT_EQ(0, tier->GetMisses());
+  EXPECT_EQ(num_pages - buffer_pool_size, tier->GetSize());
+
+  // Scenario: deleting a page that is not in the buffer pool drops its compressed copy.
+  ASSERT_TRUE(bpm->DeletePage(0));
+  EXPECT_EQ(num_pages - buffer_pool_size - 1, tier->GetSize());
+
+  delete bpm;
+  delete disk_manager;
+  remove("test.db");
+  remove("test.fsm");
+}
+
+}  // namespace bustub
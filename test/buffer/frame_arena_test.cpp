@@ -0,0 +1,81 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// frame_arena_test.cpp
+//
+// Identification: test/buffer/frame_arena_test.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <cstdint>
+#include <cstring>
+
+#include "buffer/buffer_pool_manager_instance.h"
+#include "buffer/frame_arena.h"
+#include "gtest/gtest.h"
+
+namespace bustub {
+
+// NOLINTNEXTLINE
+TEST(FrameArenaTest, SampleTest) {
+  const size_t num_frames = 100;
+  for (bool huge_pages : {false, true}) {
+    FrameArena arena(num_frames, huge_pages);
+
+    // Scenario: frames are back to back, aligned for direct I/O, and read as zeros until written.
+    for (size_t i = 0; i < num_frames; ++i) {
+      char *frame = arena.GetFrame(static_cast<frame_id_t>(i));
+      EXPECT_EQ(0, reinterpret_cast<uintptr_t>(frame) % PAGE_SIZE);
+      EXPECT_EQ(arena.GetFrame(0) + i * PAGE_SIZE, frame);
+      EXPECT_EQ(0, frame[0]);
+      EXPECT_EQ(0, frame[PAGE_SIZE - 1]);
+      memset(frame, 'x', PAGE_SIZE);
+    }
+    EXPECT_EQ(0, reinterpret_cast<uintptr_t>(arena.GetFrame(0)) % arena.GetGranularity());
+
+    // Scenario: releasing every frame gives the memory back, and the frames read as zeros again.
+    arena.Release(0, num_frames);
+    size_t released = num_frames * PAGE_SIZE / arena.GetGranularity() * arena.GetGranularity() / PAGE_SIZE;
+    for (size_t i = 0; i < released; ++i) {
+      EXPECT_EQ(0, arena.GetFrame(static_cast<frame_id_t>(i))[0]);
+    }
+    // Frames that share a page of the mapping with frames in use keep their data.
+    for (size_t i = released; i < num_frames; ++i) {
+      EXPECT_EQ('x', arena.GetFrame(static_cast<frame_id_t>(i))[0]);
+    }
+  }
+}
+
+// NOLINTNEXTLINE
+TEST(FrameArenaTest, BufferPoolFramesTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 10;
+
+  auto *disk_manager = new DiskManager(db_name);
+  BufferPoolOptions options;
+  options.huge_pages_ = true;
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager, nullptr, options);
+
+  // Scenario: the pages of the buffer pool hand out aligned, distinct frames.
+  Page *pages[buffer_pool_size];
+  for (auto &page : pages) {
+    page_id_t page_id_temp;
+    page = bpm->NewPage(&page_id_temp);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ(0, reinterpret_cast<uintptr_t>(page->GetData()) % PAGE_SIZE);
+  }
+  for (size_t i = 1; i < buffer_pool_size; ++i) {
+    EXPECT_EQ(pages[0]->GetData() + i * PAGE_SIZE, pages[i]->GetData());
+  }
+
+  disk_manager->ShutDown();
+  remove("test.db");
+
+  delete bpm;
+  delete disk_manager;
+}
+
+}  // namespace bustub
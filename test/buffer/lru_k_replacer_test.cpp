@@ -0,0 +1,213 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// lru_k_replacer_test.cpp
+//
+// Identification: test/buffer/lru_k_replacer_test.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <chrono>  // NOLINT
+#include <cstdio>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "buffer/lru_k_replacer.h"
+#include "gtest/gtest.h"
+
+namespace bustub {
+
+/** LRUKReplacer on a clock that only moves when the test advances it. */
+class ManualClockLRUKReplacer : public LRUKReplacer {
+ public:
+  using LRUKReplacer::LRUKReplacer;
+
+  void Advance(std::chrono::nanoseconds duration) { now_ += duration; }
+
+ protected:
+  std::chrono::steady_clock::time_point Now() const override { return now_; }
+
+ private:
+  std::chrono::steady_clock::time_point now_;
+};
+
+TEST(LRUKReplacerTest, SampleTest) {
+  LRUKReplacer lru_k_replacer(7, 2, std::chrono::nanoseconds(0));
+
+  // Scenario: reference frames 1-6 once, and frame 1 a second time.
+  for (int i = 1; i <= 6; ++i) {
+    lru_k_replacer.Pin(i);
+  }
+  lru_k_replacer.Pin(1);
+  for (int i = 1; i <= 6; ++i) {
+    lru_k_replacer.Unpin(i);
+  }
+  EXPECT_EQ(6, lru_k_replacer.Size());
+
+  // Scenario: frames with a single reference have an infinite backward 2-distance and go first, oldest first.
+  // Frame 1 has two references, so it is evicted last.
+  int value;
+  lru_k_replacer.Victim(&value);
+  EXPECT_EQ(2, value);
+  lru_k_replacer.Victim(&value);
+  EXPECT_EQ(3, value);
+  EXPECT_EQ(4, lru_k_replacer.Size());
+
+  // Scenario: pin frame 4 twice, which gives it a finite backward 2-distance younger than frame 1's.
+  lru_k_replacer.Pin(4);
+  lru_k_replacer.Pin(4);
+  EXPECT_EQ(3, lru_k_replacer.Size());
+  lru_k_replacer.Unpin(4);
+
+  lru_k_replacer.Victim(&value);
+  EXPECT_EQ(5, value);
+  lru_k_replacer.Victim(&value);
+  EXPECT_EQ(6, value);
+  lru_k_replacer.Victim(&value);
+  EXPECT_EQ(1, value);
+  lru_k_replacer.Victim(&value);
+  EXPECT_EQ(4, value);
+  EXPECT_EQ(false, lru_k_replacer.Victim(&value));
+  EXPECT_EQ(0, lru_k_replacer.Size());
+}
+
+TEST(LRUKReplacerTest, ScanResistanceTest) {
+  LRUKReplacer lru_k_replacer(10, 2, std::chrono::nanoseconds(0));
+
+  // Scenario: frames 0-2 hold hot pages referenced twice each.
+  for (int round = 0; round < 2; ++round) {
+    for (int i = 0; i < 3; ++i) {
+      lru_k_replacer.Pin(i);
+      lru_k_replacer.Unpin(i);
+    }
+  }
+
+  // Scenario: a scan touches frames 3-9 once each, after the hot pages. Plain LRU would now evict frame 0.
+  for (int i = 3; i < 10; ++i) {
+    lru_k_replacer.Pin(i);
+    lru_k_replacer.Unpin(i);
+  }
+
+  int value;
+  for (int i = 3; i < 10; ++i) {
+    ASSERT_EQ(true, lru_k_replacer.Victim(&value));
+    EXPECT_EQ(i, value);
+  }
+  ASSERT_EQ(true, lru_k_replacer.Victim(&value));
+  EXPECT_EQ(0, value);
+}
+
+TEST(LRUKReplacerTest, CorrelatedReferenceTest) {
+  ManualClockLRUKReplacer lru_k_replacer(4, 2, std::chrono::milliseconds(3));
+
+  // Scenario: frame 0 is pinned three times in a row, e.g. once per tuple by a scan. The references fall inside the
+  // correlated reference period, so they count as one and the frame still has an infinite backward 2-distance.
+  lru_k_replacer.Pin(0);
+  lru_k_replacer.Pin(0);
+  lru_k_replacer.Pin(0);
+  lru_k_replacer.Unpin(0);
+
+  // Scenario: frame 1 is referenced twice, far enough apart to be uncorrelated.
+  lru_k_replacer.Pin(1);
+  lru_k_replacer.Unpin(1);
+  for (int i = 0; i < 4; ++i) {
+    lru_k_replacer.Pin(2);
+  }
+  lru_k_replacer.Unpin(2);
+  lru_k_replacer.Advance(std::chrono::milliseconds(5));
+  lru_k_replacer.Pin(1);
+  lru_k_replacer.Unpin(1);
+
+  int value;
+  lru_k_replacer.Victim(&value);
+  EXPECT_EQ(0, value);
+  lru_k_replacer.Victim(&value);
+  EXPECT_EQ(2, value);
+  lru_k_replacer.Victim(&value);
+  EXPECT_EQ(1, value);
+}
+
+TEST(LRUKReplacerTest, InterleavedReferenceTest) {
+  ManualClockLRUKReplacer lru_k_replacer(8, 2, std::chrono::milliseconds(1));
+
+  // Scenario: frame 0 is pinned twice by one operation while concurrent queries reference every other frame in
+  // between. The references are still correlated, because the period is time and not other references.
+  lru_k_replacer.Pin(0);
+  for (int i = 1; i < 8; ++i) {
+    lru_k_replacer.Pin(i);
+    lru_k_replacer.Unpin(i);
+  }
+  lru_k_replacer.Pin(0);
+  lru_k_replacer.Unpin(0);
+
+  // Scenario: frame 1 is referenced again after the period, so it is the only frame with two references.
+  lru_k_replacer.Advance(std::chrono::milliseconds(2));
+  lru_k_replacer.Pin(1);
+  lru_k_replacer.Unpin(1);
+
+  int value;
+  for (int i : {0, 2, 3, 4, 5, 6, 7, 1}) {
+    ASSERT_EQ(true, lru_k_replacer.Victim(&value));
+    EXPECT_EQ(i, value);
+  }
+}
+
+TEST(LRUKReplacerTest, ContinuousReferenceTest) {
+  ManualClockLRUKReplacer lru_k_replacer(2, 2, std::chrono::milliseconds(1));
+
+  // Scenario: frame 0 is referenced every 100us for 2ms. The references are never further apart than the period, but
+  // they are counted once per period, so the frame ends up with a finite backward 2-distance.
+  lru_k_replacer.Pin(1);
+  lru_k_replacer.Unpin(1);
+  for (int i = 0; i < 20; ++i) {
+    lru_k_replacer.Pin(0);
+    lru_k_replacer.Unpin(0);
+    lru_k_replacer.Advance(std::chrono::microseconds(100));
+  }
+
+  int value;
+  lru_k_replacer.Victim(&value);
+  EXPECT_EQ(1, value);
+  lru_k_replacer.Victim(&value);
+  EXPECT_EQ(0, value);
+}
+
+TEST(LRUKReplacerTest, RetainedHistoryTest) {
+  ManualClockLRUKReplacer lru_k_replacer(2, 2, std::chrono::milliseconds(1));
+  int value;
+
+  // Scenario: page 10 is referenced once in frame 0 and evicted.
+  lru_k_replacer.SetPage(0, 10, false);
+  lru_k_replacer.Pin(0);
+  lru_k_replacer.Unpin(0);
+  ASSERT_EQ(true, lru_k_replacer.Victim(&value));
+  EXPECT_EQ(0, value);
+
+  // Scenario: page 11 is referenced once, then page 10 comes back in frame 0. Its history survived the eviction, so
+  // this is its second reference and page 11 goes first.
+  lru_k_replacer.Advance(std::chrono::milliseconds(2));
+  lru_k_replacer.SetPage(1, 11, false);
+  lru_k_replacer.Pin(1);
+  lru_k_replacer.Unpin(1);
+  lru_k_replacer.Advance(std::chrono::milliseconds(2));
+  lru_k_replacer.SetPage(0, 10, false);
+  lru_k_replacer.Pin(0);
+  lru_k_replacer.Unpin(0);
+  ASSERT_EQ(true, lru_k_replacer.Victim(&value));
+  EXPECT_EQ(1, value);
+
+  // Scenario: a new page created on the id of the evicted page 11 does not inherit its history.
+  lru_k_replacer.Advance(std::chrono::milliseconds(2));
+  lru_k_replacer.SetPage(1, 11, true);
+  lru_k_replacer.Pin(1);
+  lru_k_replacer.Unpin(1);
+  ASSERT_EQ(true, lru_k_replacer.Victim(&value));
+  EXPECT_EQ(1, value);
+  ASSERT_EQ(true, lru_k_replacer.Victim(&value));
+  EXPECT_EQ(0, value);
+}
+
+}  // namespace bustub
@@ -59,4 +59,50 @@ TEST(LRUReplacerTest, SampleTest) {
   EXPECT_EQ(4, value);
 }
 
+TEST(LRUReplacerTest, ConcurrentPinUnpinTest) {
+  const int num_threads = 4;
+  const int frames_per_thread = 8;
+  const int num_rounds = 10000;
+  LRUReplacer lru_replacer(num_threads * frames_per_thread);
+
+  // Scenario: threads pin and unpin their own frames concurrently, as buffer pool hits on different pages do, while
+  // another thread keeps taking victims and giving them back.
+  std::vector<std::thread> threads;
+  for (int t = 0; t < num_threads; t++) {
+    threads.emplace_back([&lru_replacer, t] {
+      for (int round = 0; round < num_rounds; round++) {
+        for (int i = 0; i < frames_per_thread; i++) {
+          lru_replacer.Pin(t * frames_per_thread + i);
+          lru_replacer.Unpin(t * frames_per_thread + i);
+        }
+      }
+    });
+  }
+  std::thread victimizer([&lru_replacer] {
+    for (int round = 0; round < num_rounds; round++) {
+      int value;
+      if (lru_replacer.Victim(&value)) {
+        lru_replacer.Unpin(value);
+      }
+    }
+  });
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  victimizer.join();
+
+  // Scenario: every frame ends up in the replacer exactly once.
+  EXPECT_EQ(num_threads * frames_per_thread, lru_replacer.Size());
+  std::vector<bool> seen(num_threads * frames_per_thread, false);
+  int value;
+  while (lru_replacer.Victim(&value)) {
+    ASSERT_FALSE(seen[value]);
+    seen[value] = true;
+  }
+  EXPECT_EQ(0, lru_replacer.Size());
+  for (bool frame_seen : seen) {
+    EXPECT_TRUE(frame_seen);
+  }
+}
+
 }  // namespace bustub
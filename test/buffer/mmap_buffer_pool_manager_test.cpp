@@ -0,0 +1,83 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// mmap_buffer_pool_manager_test.cpp
+//
+// Identification: test/buffer/mmap_buffer_pool_manager_test.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/mmap_buffer_pool_manager.h"
+
+#include <cstdio>
+#include <cstring>
+
+#include "gtest/gtest.h"
+#include "storage/disk/disk_manager.h"
+
+namespace bustub {
+
+// NOLINTNEXTLINE
+TEST(MmapBufferPoolManagerTest, ReadOnlyTest) {
+  const std::string db_name = "test.db";
+  const int num_pages = 5;
+  remove(db_name.c_str());
+  auto *disk_manager = new DiskManager(db_name);
+  char data[PAGE_SIZE] = {0};
+  for (int i = 0; i < num_pages; ++i) {
+    snprintf(data, PAGE_SIZE, "page %d", i);
+    disk_manager->WritePage(i, data);
+  }
+  disk_manager->ShutDown();
+  delete disk_manager;
+
+  auto *bpm = new MmapBufferPoolManager(db_name);
+  EXPECT_EQ(num_pages, bpm->GetPoolSize());
+
+  // Scenario: every page of the file can be fetched, and fetching it twice returns the same view without a copy.
+  for (int i = 0; i < num_pages; ++i) {
+    auto *page = bpm->FetchPage(i);
+    ASSERT_NE(nullptr, page);
+    snprintf(data, PAGE_SIZE, "page %d", i);
+    EXPECT_EQ(0, strcmp(page->GetData(), data));
+    EXPECT_EQ(i, page->GetPageId());
+    EXPECT_FALSE(page->IsDirty());
+    EXPECT_EQ(page, bpm->FetchPage(i));
+    EXPECT_EQ(2, page->GetPinCount());
+  }
+  EXPECT_EQ(bpm->FetchPage(0)->GetData() + PAGE_SIZE, bpm->FetchPage(1)->GetData());
+
+  // Scenario: pins are counted as in a buffer pool, and read guards work on the views.
+  for (int i = 0; i < num_pages; ++i) {
+    int pins = i < 2 ? 3 : 2;
+    for (int j = 0; j < pins; ++j) {
+      EXPECT_EQ(true, bpm->UnpinPage(i, false));
+    }
+    EXPECT_EQ(false, bpm->UnpinPage(i, false));
+  }
+  {
+    auto guard = bpm->FetchPageRead(3);
+    ASSERT_TRUE(guard.IsValid());
+    EXPECT_EQ(0, strcmp(guard.GetData(), "page 3"));
+  }
+  EXPECT_EQ(false, bpm->UnpinPage(3, false));
+
+  // Scenario: pages beyond the end of the file do not exist, and the file cannot be changed.
+  EXPECT_EQ(nullptr, bpm->FetchPage(num_pages));
+  EXPECT_EQ(nullptr, bpm->FetchPage(INVALID_PAGE_ID));
+  page_id_t page_id_temp = 0;
+  EXPECT_EQ(nullptr, bpm->NewPage(&page_id_temp));
+  EXPECT_EQ(INVALID_PAGE_ID, page_id_temp);
+  EXPECT_EQ(false, bpm->DeletePage(0));
+  EXPECT_EQ(true, bpm->FlushPage(0));
+  bpm->FlushAllPages();
+
+  delete bpm;
+  remove(db_name.c_str());
+  remove("test.log");
+}
+
+}  // namespace bustub
@@ -11,10 +11,13 @@
 //===----------------------------------------------------------------------===//
 
 #include "buffer/parallel_buffer_pool_manager.h"
+#include <algorithm>
 #include <cstdio>
 #include <random>
 #include <string>
+#include <vector>
 #include "buffer/buffer_pool_manager.h"
+#include "common/util/numa_util.h"
 #include "gtest/gtest.h"
 
 namespace bustub {
@@ -151,4 +154,180 @@ TEST(ParallelBufferPoolManagerTest, SampleTest) {
   delete disk_manager;
 }
 
+// NOLINTNEXTLINE
+TEST(ParallelBufferPoolManagerTest, FlushAllPagesTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 4;
+  const size_t num_instances = 3;
+  const int num_pages = buffer_pool_size * num_instances;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new ParallelBufferPoolManager(num_instances, buffer_pool_size, disk_manager);
+
+  std::vector<page_id_t> page_ids;
+  for (int i = 0; i < num_pages; ++i) {
+    page_id_t page_id_temp;
+    auto *page = bpm->NewPage(&page_id_temp);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), PAGE_SIZE, "page %d", page_id_temp);
+    page_ids.push_back(page_id_temp);
+  }
+  for (page_id_t page_id : page_ids) {
+    EXPECT_EQ(true, bpm->UnpinPage(page_id, true));
+  }
+
+  // Scenario: flushing writes back the pages of every instance.
+  bpm->FlushAllPages();
+  EXPECT_EQ(num_pages, disk_manager->GetNumWrites());
+
+  // Scenario: a fresh buffer pool reads back what was flushed.
+  delete bpm;
+  bpm = new ParallelBufferPoolManager(num_instances, buffer_pool_size, disk_manager);
+  char expected[PAGE_SIZE];
+  for (page_id_t page_id : page_ids) {
+    auto *page = bpm->FetchPage(page_id);
+    ASSERT_NE(nullptr, page);
+    snprintf(expected, PAGE_SIZE, "page %d", page_id);
+    EXPECT_EQ(0, strcmp(page->GetData(), expected));
+    EXPECT_EQ(true, bpm->UnpinPage(page_id, false));
+  }
+
+  disk_manager->ShutDown();
+  remove("test.db");
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(ParallelBufferPoolManagerTest, NewPageStartInstanceTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 10;
+  const size_t num_instances = 5;
+
+  auto *disk_manager = new DiskManager(db_name);
+
+  // Scenario: consecutive allocations start at consecutive instances, even though none of them is full.
+  auto *bpm = new ParallelBufferPoolManager(num_instances, buffer_pool_size, disk_manager);
+  std::vector<int> pages_per_instance(num_instances, 0);
+  for (size_t i = 0; i < 2 * num_instances; ++i) {
+    page_id_t page_id_temp;
+    ASSERT_NE(nullptr, bpm->NewPage(&page_id_temp));
+    pages_per_instance[page_id_temp % num_instances]++;
+    EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, false));
+  }
+  for (size_t i = 0; i < num_instances; ++i) {
+    EXPECT_EQ(2, pages_per_instance[i]);
+  }
+  delete bpm;
+
+  // Scenario: with thread affinity, a thread allocates from its home instance until that instance is full.
+  BufferPoolOptions options;
+  options.new_page_thread_affinity_ = true;
+  bpm = new ParallelBufferPoolManager(num_instances, buffer_pool_size, disk_manager, nullptr, options);
+  page_id_t first_page_id;
+  ASSERT_NE(nullptr, bpm->NewPage(&first_page_id));
+  for (size_t i = 1; i < buffer_pool_size; ++i) {
+    page_id_t page_id_temp;
+    ASSERT_NE(nullptr, bpm->NewPage(&page_id_temp));
+    EXPECT_EQ(first_page_id % num_instances, page_id_temp % num_instances);
+  }
+  page_id_t page_id_temp;
+  ASSERT_NE(nullptr, bpm->NewPage(&page_id_temp));
+  EXPECT_NE(first_page_id % num_instances, page_id_temp % num_instances);
+
+  disk_manager->ShutDown();
+  remove("test.db");
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(ParallelBufferPoolManagerTest, ResizeTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 4;
+  const size_t num_instances = 2;
+
+  auto *disk_manager = new DiskManager(db_name);
+  BufferPoolOptions options;
+  options.max_pool_size_ = 2 * buffer_pool_size;
+  auto *bpm = new ParallelBufferPoolManager(num_instances, buffer_pool_size, disk_manager, nullptr, options);
+  const int num_pages = static_cast<int>(num_instances * buffer_pool_size);
+  for (int i = 0; i < num_pages; ++i) {
+    page_id_t page_id_temp;
+    ASSERT_NE(nullptr, bpm->NewPage(&page_id_temp));
+  }
+
+  // Scenario: a size out of range changes no instance.
+  EXPECT_EQ(false, bpm->Resize(2 * buffer_pool_size + 1));
+  EXPECT_EQ(num_instances * buffer_pool_size, bpm->GetPoolSize());
+
+  // Scenario: instance 0 could shrink, but instance 1 keeps its pages pinned. Instance 0 grows back, so the pool
+  // keeps its old size everywhere.
+  for (int i = 0; i < num_pages; i += 2) {
+    EXPECT_EQ(true, bpm->UnpinPage(i, false));
+  }
+  EXPECT_EQ(false, bpm->Resize(buffer_pool_size / 2, std::chrono::milliseconds(10)));
+  EXPECT_EQ(num_instances * buffer_pool_size, bpm->GetPoolSize());
+  EXPECT_EQ(buffer_pool_size, bpm->size_pool);
+  for (auto *manager : bpm->managers_) {
+    EXPECT_EQ(buffer_pool_size, manager->GetPoolSize());
+  }
+
+  // Scenario: once every page is unpinned, every instance shrinks.
+  for (int i = 1; i < num_pages; i += 2) {
+    EXPECT_EQ(true, bpm->UnpinPage(i, false));
+  }
+  EXPECT_EQ(true, bpm->Resize(buffer_pool_size / 2));
+  EXPECT_EQ(num_instances * buffer_pool_size / 2, bpm->GetPoolSize());
+  EXPECT_EQ(buffer_pool_size / 2, bpm->size_pool);
+
+  disk_manager->ShutDown();
+  remove("test.db");
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(ParallelBufferPoolManagerTest, NumaAwareTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 10;
+  const size_t num_instances = 4;
+
+  auto *disk_manager = new DiskManager(db_name);
+  BufferPoolOptions options;
+  options.numa_aware_ = true;
+  auto *bpm = new ParallelBufferPoolManager(num_instances, buffer_pool_size, disk_manager, nullptr, options);
+
+  // Scenario: the instances are spread over the nodes round-robin.
+  size_t num_nodes = std::min(static_cast<size_t>(NumaUtil::NumNodes()), num_instances);
+  for (size_t i = 0; i < num_instances; ++i) {
+    EXPECT_EQ(static_cast<int>(i % num_nodes), bpm->managers_[i]->GetNumaNode());
+  }
+
+  // Scenario: a thread on node 0 allocates from the instances of node 0 until they are full, then from the others.
+  NumaUtil::RunOnNode(0);
+  size_t num_local = (num_instances + num_nodes - 1) / num_nodes;
+  for (size_t i = 0; i < num_local * buffer_pool_size; ++i) {
+    page_id_t page_id_temp;
+    ASSERT_NE(nullptr, bpm->NewPage(&page_id_temp));
+    EXPECT_EQ(0, page_id_temp % num_instances % num_nodes);
+  }
+  for (size_t i = num_local * buffer_pool_size; i < num_instances * buffer_pool_size; ++i) {
+    page_id_t page_id_temp;
+    ASSERT_NE(nullptr, bpm->NewPage(&page_id_temp));
+  }
+  page_id_t page_id_temp;
+  EXPECT_EQ(nullptr, bpm->NewPage(&page_id_temp));
+  NumaUtil::RunOnNode(-1);
+
+  disk_manager->ShutDown();
+  remove("test.db");
+
+  delete bpm;
+  delete disk_manager;
+}
+
 }  // namespace bustub
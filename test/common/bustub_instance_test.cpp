@@ -0,0 +1,53 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// bustub_instance_test.cpp
+//
+// Identification: test/common/bustub_instance_test.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <cstdio>
+#include <string>
+
+#include "common/bustub_instance.h"
+#include "gtest/gtest.h"
+
+namespace bustub {
+
+// NOLINTNEXTLINE
+TEST(BustubInstanceTest, BufferPoolOptionsTest) {
+  const std::string db_name = "test.db";
+
+  // Scenario: the default instance keeps the compile-time pool size.
+  auto *instance = new BustubInstance(db_name);
+  EXPECT_NE(nullptr, dynamic_cast<BufferPoolManagerInstance *>(instance->buffer_pool_manager_));
+  EXPECT_EQ(BUFFER_POOL_SIZE, instance->buffer_pool_manager_->GetPoolSize());
+  delete instance;
+
+  // Scenario: several instances build a parallel buffer pool of the requested total size.
+  BustubOptions options;
+  options.buffer_pool_size_ = 16;
+  options.buffer_pool_instances_ = 4;
+  options.buffer_pool_options_.replacer_type_ = ReplacerType::CLOCK;
+  instance = new BustubInstance(db_name, options);
+  EXPECT_NE(nullptr, dynamic_cast<ParallelBufferPoolManager *>(instance->buffer_pool_manager_));
+  EXPECT_EQ(64, instance->buffer_pool_manager_->GetPoolSize());
+
+  // Scenario: every frame of every instance can be used.
+  for (int i = 0; i < 64; ++i) {
+    page_id_t page_id_temp;
+    EXPECT_NE(nullptr, instance->buffer_pool_manager_->NewPage(&page_id_temp));
+  }
+  page_id_t page_id_temp;
+  EXPECT_EQ(nullptr, instance->buffer_pool_manager_->NewPage(&page_id_temp));
+  delete instance;
+
+  remove(db_name.c_str());
+  remove("test.log");
+}
+
+}  // namespace bustub
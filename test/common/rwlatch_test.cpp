@@ -10,6 +10,8 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <atomic>
+#include <chrono>  // NOLINT
 #include <thread>  // NOLINT
 #include <vector>
 
@@ -57,4 +59,129 @@ TEST(RWLatchTest, BasicTest) {
   }
   EXPECT_EQ(counter.Read(), 55);
 }
+
+// NOLINTNEXTLINE
+TEST(RWLatchTest, SizeTest) { EXPECT_LE(sizeof(ReaderWriterLatch), 8); }
+
+// NOLINTNEXTLINE
+TEST(RWLatchTest, ExclusionStressTest) {
+  const int num_threads = 16;
+  const int num_iterations = 20000;
+  ReaderWriterLatch latch;
+  std::atomic<int> readers{0};
+  std::atomic<int> writers{0};
+  std::atomic<bool> violated{false};
+  int64_t count = 0;
+
+  // Scenario: every thread mixes reads and writes; a writer never overlaps anyone, readers never overlap a writer.
+  std::vector<std::thread> threads;
+  for (int tid = 0; tid < num_threads; tid++) {
+    threads.emplace_back([&, tid] {
+      for (int i = 0; i < num_iterations; i++) {
+        if ((i + tid) % 4 == 0) {
+          latch.WLock();
+          if (writers.fetch_add(1) != 0 || readers.load() != 0) {
+            violated = true;
+          }
+          count++;
+          writers.fetch_sub(1);
+          latch.WUnlock();
+        } else {
+          latch.RLock();
+          readers.fetch_add(1);
+          if (writers.load() != 0) {
+            violated = true;
+          }
+          readers.fetch_sub(1);
+          latch.RUnlock();
+        }
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  EXPECT_FALSE(violated);
+  EXPECT_EQ(num_threads * num_iterations / 4, count);
+}
+
+// NOLINTNEXTLINE
+TEST(RWLatchTest, SharedReadersTest) {
+  const int num_readers = 8;
+  ReaderWriterLatch latch;
+  std::atomic<int> inside{0};
+
+  // Scenario: all readers can hold the latch at the same time.
+  std::vector<std::thread> threads;
+  for (int tid = 0; tid < num_readers; tid++) {
+    threads.emplace_back([&] {
+      latch.RLock();
+      inside.fetch_add(1);
+      while (inside.load() < num_readers) {
+        std::this_thread::yield();
+      }
+      latch.RUnlock();
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  EXPECT_EQ(num_readers, inside.load());
+}
+
+// NOLINTNEXTLINE
+TEST(RWLatchTest, WriterPreferenceTest) {
+  ReaderWriterLatch latch;
+  std::atomic<bool> writer_done{false};
+  std::atomic<bool> late_reader_saw_writer{false};
+
+  // Scenario: a writer waits on a reader; a reader that arrives after it does not get in before the writer.
+  latch.RLock();
+  std::thread writer([&] {
+    latch.WLock();
+    writer_done = true;
+    latch.WUnlock();
+  });
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  std::thread late_reader([&] {
+    latch.RLock();
+    late_reader_saw_writer = writer_done.load();
+    latch.RUnlock();
+  });
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  EXPECT_FALSE(writer_done);
+  latch.RUnlock();
+  writer.join();
+  late_reader.join();
+  EXPECT_TRUE(late_reader_saw_writer);
+}
+
+// NOLINTNEXTLINE
+TEST(RWLatchTest, ParkedWaitersTest) {
+  const int num_threads = 8;
+  ReaderWriterLatch latch;
+  int count = 0;
+
+  // Scenario: threads that wait long enough to park are all woken up by the unlock.
+  latch.WLock();
+  std::vector<std::thread> threads;
+  for (int tid = 0; tid < num_threads; tid++) {
+    threads.emplace_back([&, tid] {
+      if (tid % 2 == 0) {
+        latch.RLock();
+        latch.RUnlock();
+      } else {
+        latch.WLock();
+        count++;
+        latch.WUnlock();
+      }
+    });
+  }
+  std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  latch.WUnlock();
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  EXPECT_EQ(num_threads / 2, count);
+}
 }  // namespace bustub
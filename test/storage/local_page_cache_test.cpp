@@ -0,0 +1,138 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// local_page_cache_test.cpp
+//
+// Identification: test/storage/local_page_cache_test.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <cstdio>
+#include <cstring>
+
+#include "buffer/buffer_pool_manager_instance.h"
+#include "gtest/gtest.h"
+#include "storage/disk/disk_manager.h"
+#include "storage/disk/local_page_cache.h"
+
+namespace bustub {
+
+class LocalPageCacheTest : public ::testing::Test {
+ protected:
+  // This function is called before every test.
+  void SetUp() override {
+    remove("test.db");
+    remove("test.log");
+  }
+
+  // This function is called after every test.
+  void TearDown() override {
+    remove("test.db");
+    remove("test.log");
+  };
+};
+
+// NOLINTNEXTLINE
+TEST_F(LocalPageCacheTest, AdmissionTest) {
+  LocalPageCache cache("test_cache.tmp", 2, 2);
+  char data[PAGE_SIZE] = {0};
+  char buf[PAGE_SIZE] = {0};
+
+  // Scenario: a page is admitted on its second eviction, and reads back from the cache.
+  snprintf(data, PAGE_SIZE, "page 1");
+  cache.FinishAdmit(1, data, cache.BeginAdmit(1));
+  EXPECT_FALSE(cache.ReadPage(1, buf));
+  cache.FinishAdmit(1, data, cache.BeginAdmit(1));
+  EXPECT_TRUE(cache.ReadPage(1, buf));
+  EXPECT_EQ(0, strcmp(buf, "page 1"));
+  EXPECT_EQ(1, cache.GetAdmissions());
+
+  // Scenario: an admission that raced with a write of the page is dropped, and a write drops the cached copy.
+  snprintf(data, PAGE_SIZE, "page 2");
+  cache.BeginAdmit(2);
+  uint64_t ticket = cache.BeginAdmit(2);
+  ASSERT_NE(0, ticket);
+  cache.Invalidate(2);
+  cache.FinishAdmit(2, data, ticket);
+  EXPECT_FALSE(cache.ReadPage(2, buf));
+  cache.Invalidate(1);
+  EXPECT_FALSE(cache.ReadPage(1, buf));
+
+  // Scenario: page 1 is evicted again after its cached copy was dropped, then page 3. The admission of page 1 left no
+  // trace in the eviction history, so page 3 does not push out page 1's new count and page 1 is admitted on its next
+  // eviction.
+  snprintf(data, PAGE_SIZE, "page 1");
+  EXPECT_EQ(0, cache.BeginAdmit(1));
+  EXPECT_EQ(0, cache.BeginAdmit(3));
+  cache.FinishAdmit(1, data, cache.BeginAdmit(1));
+  EXPECT_TRUE(cache.ReadPage(1, buf));
+  EXPECT_EQ(2, cache.GetAdmissions());
+
+  // Scenario: a full cache replaces pages in CLOCK order, sparing the recently read one.
+  LocalPageCache eager("test_cache2.tmp", 2, 1);
+  for (page_id_t page_id = 0; page_id < 2; page_id++) {
+    snprintf(data, PAGE_SIZE, "page %d", page_id);
+    eager.FinishAdmit(page_id, data, eager.BeginAdmit(page_id));
+  }
+  EXPECT_TRUE(eager.ReadPage(0, buf));
+  eager.FinishAdmit(2, data, eager.BeginAdmit(2));
+  EXPECT_TRUE(eager.ReadPage(0, buf));
+  EXPECT_EQ(0, strcmp(buf, "page 0"));
+  EXPECT_FALSE(eager.ReadPage(1, buf));
+  EXPECT_TRUE(eager.ReadPage(2, buf));
+}
+
+// NOLINTNEXTLINE
+TEST_F(LocalPageCacheTest, BufferPoolTest) {
+  const size_t buffer_pool_size = 2;
+  const int num_pages = 4;
+  DiskManager disk_manager("test.db");
+  LocalPageCache cache("test_cache.tmp", 8, 1);
+  disk_manager.SetPageCache(&cache);
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, &disk_manager);
+
+  for (int i = 0; i < num_pages; ++i) {
+    page_id_t page_id_temp;
+    auto *page = bpm->NewPage(&page_id_temp);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), PAGE_SIZE, "page %d", i);
+    EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, true));
+  }
+
+  // Scenario: dirty victims go to the database file only; once they are clean, evicting them fills the cache.
+  EXPECT_EQ(0, cache.GetAdmissions());
+  for (int round = 0; round < 2; ++round) {
+    for (int i = 0; i < num_pages; ++i) {
+      auto *page = bpm->FetchPage(i);
+      ASSERT_NE(nullptr, page);
+      char expected[PAGE_SIZE];
+      snprintf(expected, PAGE_SIZE, "page %d", i);
+      EXPECT_EQ(0, strcmp(page->GetData(), expected));
+      EXPECT_EQ(true, bpm->UnpinPage(i, false));
+    }
+  }
+  EXPECT_LE(2, cache.GetAdmissions());
+  EXPECT_LE(2, cache.GetHits());
+
+  // Scenario: writing a page back invalidates its cached copy, so the next miss reads the new content.
+  auto *page = bpm->FetchPage(0);
+  ASSERT_NE(nullptr, page);
+  snprintf(page->GetData(), PAGE_SIZE, "page 0 updated");
+  EXPECT_EQ(true, bpm->UnpinPage(0, true));
+  for (int i = 1; i < num_pages; ++i) {
+    ASSERT_NE(nullptr, bpm->FetchPage(i));
+    EXPECT_EQ(true, bpm->UnpinPage(i, false));
+  }
+  page = bpm->FetchPage(0);
+  ASSERT_NE(nullptr, page);
+  EXPECT_EQ(0, strcmp(page->GetData(), "page 0 updated"));
+  EXPECT_EQ(true, bpm->UnpinPage(0, false));
+
+  delete bpm;
+  disk_manager.ShutDown();
+}
+
+}  // namespace bustub
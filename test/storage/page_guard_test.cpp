@@ -0,0 +1,123 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// page_guard_test.cpp
+//
+// Identification: test/storage/page_guard_test.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <cstdio>
+#include <utility>
+
+#include "buffer/buffer_pool_manager_instance.h"
+#include "gtest/gtest.h"
+#include "storage/page/page_guard.h"
+
+namespace bustub {
+
+// NOLINTNEXTLINE
+TEST(PageGuardTest, PinTest) {
+  const std::string db_name = "test.db";
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManagerInstance(2, disk_manager);
+  page_id_t page_id;
+
+  // Scenario: a guard holds exactly one pin and releases it at the end of its scope.
+  {
+    auto guard = bpm->NewPageGuarded(&page_id);
+    ASSERT_TRUE(guard.IsValid());
+    EXPECT_EQ(page_id, guard.PageId());
+    EXPECT_EQ(1, guard.GetPage()->GetPinCount());
+  }
+  Page *page = bpm->FetchPage(page_id);
+  EXPECT_EQ(1, page->GetPinCount());
+  bpm->UnpinPage(page_id, false);
+
+  // Scenario: moving a guard moves the pin, it does not take a second one or release it twice.
+  {
+    auto guard = bpm->FetchPageBasic(page_id);
+    BasicPageGuard moved(std::move(guard));
+    EXPECT_FALSE(guard.IsValid());  // NOLINT
+    EXPECT_EQ(1, page->GetPinCount());
+    BasicPageGuard assigned;
+    assigned = std::move(moved);
+    EXPECT_EQ(1, page->GetPinCount());
+  }
+  EXPECT_EQ(0, page->GetPinCount());
+
+  // Scenario: Drop releases the pin early, and the destructor does not release it again.
+  {
+    auto guard = bpm->FetchPageRead(page_id);
+    EXPECT_EQ(1, page->GetPinCount());
+    guard.Drop();
+    EXPECT_EQ(0, page->GetPinCount());
+  }
+  EXPECT_EQ(0, page->GetPinCount());
+
+  // Scenario: a fetch that cannot find a frame returns an empty guard.
+  {
+    page_id_t other_page_id;
+    auto pinned1 = bpm->NewPageGuarded(&other_page_id);
+    auto pinned2 = bpm->NewPageGuarded(&other_page_id);
+    auto guard = bpm->FetchPageWrite(page_id);
+    EXPECT_FALSE(guard.IsValid());
+    EXPECT_EQ(INVALID_PAGE_ID, guard.PageId());
+  }
+
+  disk_manager->ShutDown();
+  remove("test.db");
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(PageGuardTest, LatchAndDirtyTest) {
+  const std::string db_name = "test.db";
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManagerInstance(2, disk_manager);
+  page_id_t page_id;
+  Page *page = bpm->NewPage(&page_id);
+  bpm->UnpinPage(page_id, false);
+  bpm->FlushPage(page_id);
+  EXPECT_FALSE(page->IsDirty());
+
+  // Scenario: read guards share the page, and reading through them leaves it clean.
+  {
+    auto guard1 = bpm->FetchPageRead(page_id);
+    auto guard2 = bpm->FetchPageRead(page_id);
+    EXPECT_EQ(2, page->GetPinCount());
+    EXPECT_EQ(0, guard1.GetData()[0]);
+  }
+  EXPECT_FALSE(page->IsDirty());
+
+  // Scenario: a write guard holds the write latch, so the page version is odd until it is released.
+  uint64_t version = page->OptimisticReadBegin();
+  {
+    auto guard = bpm->FetchPageWrite(page_id);
+    EXPECT_EQ(1, page->OptimisticReadBegin() & 1);
+    EXPECT_EQ(0, guard.As<char>()[0]);
+  }
+  EXPECT_FALSE(page->ValidateOptimisticRead(version));
+  EXPECT_FALSE(page->IsDirty());
+
+  // Scenario: writing through the guard marks the page dirty when the guard releases it.
+  {
+    auto guard = bpm->FetchPageBasic(page_id).UpgradeWrite();
+    guard.AsMut<char>()[0] = 'a';
+  }
+  EXPECT_TRUE(page->IsDirty());
+  EXPECT_EQ(0, page->GetPinCount());
+  EXPECT_TRUE(page->ValidateOptimisticRead(page->OptimisticReadBegin()));
+  EXPECT_EQ('a', bpm->FetchPageRead(page_id).GetData()[0]);
+
+  disk_manager->ShutDown();
+  remove("test.db");
+  delete bpm;
+  delete disk_manager;
+}
+
+}  // namespace bustub
@@ -0,0 +1,135 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// page_test.cpp
+//
+// Identification: test/storage/page_test.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <array>
+#include <atomic>
+#include <cstdio>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "buffer/buffer_pool_manager_instance.h"
+#include "gtest/gtest.h"
+#include "storage/page/page.h"
+
+namespace bustub {
+
+// NOLINTNEXTLINE
+TEST(PageTest, OptimisticReadTest) {
+  const std::string db_name = "test.db";
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManagerInstance(10, disk_manager);
+  page_id_t page_id;
+  Page *page = bpm->NewPage(&page_id);
+
+  // Scenario: a read with no writer in between validates, as often as it is validated.
+  uint64_t version = page->OptimisticReadBegin();
+  EXPECT_TRUE(page->ValidateOptimisticRead(version));
+  EXPECT_TRUE(page->ValidateOptimisticRead(version));
+
+  // Scenario: reads that overlap a write latch do not validate, neither during nor after the write.
+  page->WLatch();
+  uint64_t during_write = page->OptimisticReadBegin();
+  EXPECT_FALSE(page->ValidateOptimisticRead(version));
+  EXPECT_FALSE(page->ValidateOptimisticRead(during_write));
+  page->WUnlatch();
+  EXPECT_FALSE(page->ValidateOptimisticRead(version));
+  EXPECT_FALSE(page->ValidateOptimisticRead(during_write));
+  EXPECT_TRUE(page->ValidateOptimisticRead(page->OptimisticReadBegin()));
+
+  // Scenario: read latches do not change the version.
+  version = page->OptimisticReadBegin();
+  page->RLatch();
+  page->RUnlatch();
+  EXPECT_TRUE(page->ValidateOptimisticRead(version));
+
+  // Scenario: a read that cannot get a consistent snapshot falls back to the read latch. Another thread write latches
+  // the page during every optimistic attempt, so only the read under the read latch returns.
+  page->GetData()[0] = 'a';
+  int calls = 0;
+  char value = page->ReadOptimistically([page, &calls] {
+    char read = page->GetData()[0];
+    if (++calls <= Page::MAX_OPTIMISTIC_ATTEMPTS) {
+      std::thread writer([page] {
+        page->WLatch();
+        page->GetData()[0]++;
+        page->WUnlatch();
+      });
+      writer.join();
+    }
+    return read;
+  });
+  EXPECT_EQ(Page::MAX_OPTIMISTIC_ATTEMPTS + 1, calls);
+  EXPECT_EQ('a' + Page::MAX_OPTIMISTIC_ATTEMPTS, value);
+
+  bpm->UnpinPage(page_id, true);
+  disk_manager->ShutDown();
+  remove("test.db");
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(PageTest, ConcurrentOptimisticReadTest) {
+  const std::string db_name = "test.db";
+  const int num_readers = 4;
+  const uint64_t num_writes = 20000;
+  const size_t num_words = 8;
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManagerInstance(10, disk_manager);
+  page_id_t page_id;
+  Page *page = bpm->NewPage(&page_id);
+  // The words are accessed as relaxed atomics, so that racing optimistic reads are well defined.
+  auto *words = reinterpret_cast<std::atomic<uint64_t> *>(page->GetData());
+
+  // Scenario: the writer keeps all words equal under the write latch; a validated read never sees them differ.
+  std::atomic<bool> done{false};
+  std::thread writer([&] {
+    for (uint64_t i = 1; i <= num_writes; i++) {
+      page->WLatch();
+      for (size_t w = 0; w < num_words; w++) {
+        words[w].store(i, std::memory_order_relaxed);
+      }
+      page->WUnlatch();
+    }
+    done = true;
+  });
+  std::vector<std::thread> readers;
+  for (int r = 0; r < num_readers; r++) {
+    readers.emplace_back([&] {
+      while (!done) {
+        auto snapshot = page->ReadOptimistically([&] {
+          std::array<uint64_t, num_words> values;
+          for (size_t w = 0; w < num_words; w++) {
+            values[w] = words[w].load(std::memory_order_relaxed);
+          }
+          return values;
+        });
+        for (size_t w = 1; w < num_words; w++) {
+          ASSERT_EQ(snapshot[0], snapshot[w]);
+        }
+      }
+    });
+  }
+  writer.join();
+  for (auto &reader : readers) {
+    reader.join();
+  }
+  EXPECT_EQ(num_writes, words[num_words - 1].load());
+
+  bpm->UnpinPage(page_id, true);
+  disk_manager->ShutDown();
+  remove("test.db");
+  delete bpm;
+  delete disk_manager;
+}
+
+}  // namespace bustub
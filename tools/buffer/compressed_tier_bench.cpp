@@ -0,0 +1,127 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// compressed_tier_bench.cpp
+//
+// Identification: tools/buffer/compressed_tier_bench.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+// Measures the compressed page tier. First the codec on its own: compressed size and the cost of compressing and
+// decompressing a page, next to reading the page from the database file. Then a buffer pool fetching uniformly random
+// pages of a database larger than its memory, once with all the memory as frames and once with half of it as
+// frames and half as compressed tier. Pages are filled to --fill_pct with tuples, the rest is free space.
+//
+// Disk reads go through the operating system's page cache, so their latency is a lower bound for a real device.
+//
+// Flags: --pages (database size), --memory_pages (memory of the buffer pool, in pages), --fill_pct, --fetches, --seed
+
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "benchmark/benchmark_util.h"
+#include "buffer/buffer_pool_manager_instance.h"
+#include "common/util/page_codec.h"
+
+namespace bustub {
+
+/** Fill the first fill_pct percent of a page with tuples of a few distinct values, and zero the rest. */
+static void FillPage(char *data, page_id_t page_id, uint64_t fill_pct, std::mt19937_64 *rng) {
+  memset(data, 0, PAGE_SIZE);
+  size_t used = PAGE_SIZE * fill_pct / 100;
+  size_t offset = 0;
+  while (offset + 32 <= used) {
+    offset += snprintf(data + offset, 32, "%08d|%08lu|status=%lu;", page_id, (*rng)() % 100000, (*rng)() % 4);
+  }
+}
+
+/** Codec cost next to a read from the database file. */
+static void RunCodec(const std::string &db_name, uint64_t num_pages, uint64_t fill_pct, uint64_t seed) {
+  DiskManager disk_manager(db_name);
+  std::mt19937_64 rng(seed);
+  char page[PAGE_SIZE];
+  for (uint64_t i = 0; i < num_pages; i++) {
+    FillPage(page, static_cast<page_id_t>(i), fill_pct, &rng);
+    disk_manager.WritePage(static_cast<page_id_t>(i), page);
+  }
+
+  std::vector<char> compressed(PageCodec::MaxCompressedSize());
+  uint64_t total_size = 0;
+  double compress_seconds = 0;
+  double decompress_seconds = 0;
+  double read_seconds = 0;
+  for (uint64_t i = 0; i < num_pages; i++) {
+    auto page_id = static_cast<page_id_t>(rng() % num_pages);
+    auto start = std::chrono::steady_clock::now();
+    disk_manager.ReadPage(page_id, page);
+    read_seconds += SecondsSince(start);
+    start = std::chrono::steady_clock::now();
+    size_t size = PageCodec::Compress(page, compressed.data(), compressed.size());
+    compress_seconds += SecondsSince(start);
+    start = std::chrono::steady_clock::now();
+    PageCodec::Decompress(compressed.data(), size, page);
+    decompress_seconds += SecondsSince(start);
+    total_size += size;
+  }
+  printf("codec=%s fill_pct=%lu compressed_size=%lu ratio=%.2f\n", PageCodec::Name(), fill_pct,
+         total_size / num_pages, static_cast<double>(num_pages * PAGE_SIZE) / total_size);
+  printf("%-12s %12s\n", "operation", "us/page");
+  printf("%-12s %12.2f\n", "disk read", read_seconds / num_pages * 1e6);
+  printf("%-12s %12.2f\n", "compress", compress_seconds / num_pages * 1e6);
+  printf("%-12s %12.2f\n", "decompress", decompress_seconds / num_pages * 1e6);
+  disk_manager.ShutDown();
+}
+
+/** Fetch random pages through a buffer pool with the given split of memory_pages between frames and the tier. */
+static void RunPool(const char *config, const std::string &db_name, uint64_t num_pages, uint64_t frames,
+                    uint64_t tier_pages, uint64_t fetches, uint64_t seed) {
+  DiskManager disk_manager(db_name);
+  BufferPoolOptions options;
+  options.compressed_tier_bytes_ = tier_pages * PAGE_SIZE;
+  auto *bpm = new BufferPoolManagerInstance(frames, &disk_manager, nullptr, options);
+
+  std::mt19937_64 rng(seed);
+  auto start = std::chrono::steady_clock::now();
+  for (uint64_t i = 0; i < fetches; i++) {
+    auto page_id = static_cast<page_id_t>(rng() % num_pages);
+    bpm->FetchPage(page_id);
+    bpm->UnpinPage(page_id, false);
+  }
+  double seconds = SecondsSince(start);
+
+  BufferPoolStats stats = bpm->GetStats();
+  CompressedPageTier *tier = bpm->GetCompressedTier();
+  uint64_t tier_hits = tier == nullptr ? 0 : tier->GetHits();
+  uint64_t resident = tier == nullptr ? frames : frames + tier->GetSize();
+  printf("%-10s %8lu %12lu %10.3f %12lu %14.0f\n", config, frames, resident,
+         static_cast<double>(stats.hits_ + tier_hits) / fetches, stats.misses_ - tier_hits, fetches / seconds);
+  delete bpm;
+  disk_manager.ShutDown();
+}
+
+}  // namespace bustub
+
+int main(int argc, char **argv) {
+  bustub::BenchmarkFlags flags(argc, argv);
+  const uint64_t num_pages = flags.GetInt("pages", 16384);
+  const uint64_t memory_pages = flags.GetInt("memory_pages", 4096);
+  const uint64_t fill_pct = flags.GetInt("fill_pct", 40);
+  const uint64_t fetches = flags.GetInt("fetches", 500000);
+  const uint64_t seed = flags.GetInt("seed", 42);
+  const std::string db_name = "compressed_tier_bench.db";
+
+  printf("pages=%lu memory_pages=%lu fill_pct=%lu fetches=%lu\n", num_pages, memory_pages, fill_pct, fetches);
+  bustub::RunCodec(db_name, num_pages, fill_pct, seed);
+  printf("\n%-10s %8s %12s %10s %12s %14s\n", "config", "frames", "pages_held", "mem_hits", "disk_reads", "fetches/s");
+  bustub::RunPool("frames", db_name, num_pages, memory_pages, 0, fetches, seed);
+  bustub::RunPool("tiered", db_name, num_pages, memory_pages / 2, memory_pages / 2, fetches, seed);
+  remove(db_name.c_str());
+  remove("compressed_tier_bench.log");
+  return 0;
+}
@@ -0,0 +1,96 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// mmap_scan_bench.cpp
+//
+// Identification: tools/buffer/mmap_scan_bench.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+// Read-only scans of a database file through a BufferPoolManagerInstance and through an MmapBufferPoolManager. Every
+// thread scans all pages in order --passes times, reading every word of each page under its read latch. The buffer
+// pool runs once large enough for the whole file, where scans only pay for the page table and pins, and once with a
+// quarter of it, where every page is copied in from the file again on each pass.
+//
+// The file is freshly written, so it is in the operating system's page cache for every configuration.
+//
+// Flags: --threads, --pages, --passes
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "benchmark/benchmark_util.h"
+#include "buffer/buffer_pool_manager_instance.h"
+#include "buffer/mmap_buffer_pool_manager.h"
+
+namespace bustub {
+
+/** Scan every page passes times from each thread and print the throughput. */
+static void RunScan(const char *config, BufferPoolManager *bpm, uint64_t threads, uint64_t num_pages,
+                    uint64_t passes) {
+  auto start = std::chrono::steady_clock::now();
+  std::vector<std::thread> workers;
+  std::vector<uint64_t> checksums(threads);
+  for (uint64_t t = 0; t < threads; t++) {
+    workers.emplace_back([&, t] {
+      uint64_t checksum = 0;
+      for (uint64_t pass = 0; pass < passes; pass++) {
+        for (uint64_t i = 0; i < num_pages; i++) {
+          auto guard = bpm->FetchPageRead(static_cast<page_id_t>(i));
+          const auto *words = guard.As<uint64_t>();
+          for (size_t w = 0; w < PAGE_SIZE / sizeof(uint64_t); w++) {
+            checksum += words[w];
+          }
+        }
+      }
+      checksums[t] = checksum;
+    });
+  }
+  for (auto &worker : workers) {
+    worker.join();
+  }
+  double seconds = SecondsSince(start);
+  uint64_t pages = threads * passes * num_pages;
+  printf("%-12s %16.0f %12.2f\n", config, pages / seconds, pages * PAGE_SIZE / seconds / 1e9);
+}
+
+}  // namespace bustub
+
+int main(int argc, char **argv) {
+  bustub::BenchmarkFlags flags(argc, argv);
+  const uint64_t threads = flags.GetInt("threads", std::max(1U, std::thread::hardware_concurrency()));
+  const uint64_t num_pages = flags.GetInt("pages", 32768);
+  const uint64_t passes = flags.GetInt("passes", 5);
+  const std::string db_name = "mmap_scan_bench.db";
+
+  auto *disk_manager = new bustub::DiskManager(db_name);
+  char data[bustub::PAGE_SIZE];
+  for (uint64_t i = 0; i < num_pages; i++) {
+    memset(data, static_cast<int>(i), bustub::PAGE_SIZE);
+    disk_manager->WritePage(static_cast<bustub::page_id_t>(i), data);
+  }
+
+  printf("threads=%lu pages=%lu passes=%lu\n", threads, num_pages, passes);
+  printf("%-12s %16s %12s\n", "config", "pages/s", "GB/s");
+  for (uint64_t pool_size : {num_pages, num_pages / 4}) {
+    auto *bpm = new bustub::BufferPoolManagerInstance(pool_size, disk_manager);
+    bustub::RunScan(pool_size == num_pages ? "bpm" : "bpm 1/4", bpm, threads, num_pages, passes);
+    delete bpm;
+  }
+  disk_manager->ShutDown();
+  delete disk_manager;
+
+  auto *mmap_bpm = new bustub::MmapBufferPoolManager(db_name);
+  bustub::RunScan("mmap", mmap_bpm, threads, num_pages, passes);
+  delete mmap_bpm;
+  remove(db_name.c_str());
+  remove("mmap_scan_bench.log");
+  return 0;
+}
@@ -0,0 +1,100 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// numa_bench.cpp
+//
+// Identification: tools/buffer/numa_bench.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+// Compares buffer pool hits on node-local and remote memory. Worker threads are pinned to node 0 and fetch random
+// resident pages of a BufferPoolManagerInstance whose frames are bound to node 0 ("local") or to the last node
+// ("remote"), reading every byte of each page before unpinning it. On a single-node machine, or without libnuma, both
+// rows measure the same memory.
+//
+// Flags: --threads, --pages (resident pages per pool), --fetches_per_thread, --seed
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "benchmark/benchmark_util.h"
+#include "buffer/buffer_pool_manager_instance.h"
+#include "common/util/numa_util.h"
+
+namespace bustub {
+
+/** Fill a pool bound to node with pages, then fetch them at random from threads running on node 0. */
+static void RunPlacement(const char *placement, int node, uint64_t threads, uint64_t num_pages,
+                         uint64_t fetches_per_thread, uint64_t seed) {
+  const std::string db_name = "numa_bench.db";
+  auto *disk_manager = new DiskManager(db_name);
+  BufferPoolOptions options;
+  options.numa_node_ = node;
+  auto *bpm = new BufferPoolManagerInstance(num_pages, disk_manager, nullptr, options);
+
+  std::vector<page_id_t> page_ids(num_pages);
+  for (auto &page_id : page_ids) {
+    Page *page = bpm->NewPage(&page_id);
+    memset(page->GetData(), static_cast<int>(page_id), PAGE_SIZE);
+    bpm->UnpinPage(page_id, true);
+  }
+
+  auto start = std::chrono::steady_clock::now();
+  std::vector<std::thread> workers;
+  std::vector<uint64_t> checksums(threads);
+  for (uint64_t t = 0; t < threads; t++) {
+    workers.emplace_back([&, t] {
+      NumaUtil::RunOnNode(0);
+      std::mt19937_64 rng(seed + t);
+      uint64_t checksum = 0;
+      for (uint64_t i = 0; i < fetches_per_thread; i++) {
+        page_id_t page_id = page_ids[rng() % num_pages];
+        Page *page = bpm->FetchPage(page_id);
+        auto *words = reinterpret_cast<const uint64_t *>(page->GetData());
+        for (size_t w = 0; w < PAGE_SIZE / sizeof(uint64_t); w++) {
+          checksum += words[w];
+        }
+        bpm->UnpinPage(page_id, false);
+      }
+      checksums[t] = checksum;
+    });
+  }
+  for (auto &worker : workers) {
+    worker.join();
+  }
+  double seconds = SecondsSince(start);
+  uint64_t fetches = threads * fetches_per_thread;
+  printf("%-10s %6d %16.0f %12.2f\n", placement, node, fetches / seconds, fetches * PAGE_SIZE / seconds / 1e9);
+
+  delete bpm;
+  disk_manager->ShutDown();
+  delete disk_manager;
+  remove(db_name.c_str());
+  remove("numa_bench.log");
+}
+
+}  // namespace bustub
+
+int main(int argc, char **argv) {
+  bustub::BenchmarkFlags flags(argc, argv);
+  const uint64_t threads = flags.GetInt("threads", std::max(1U, std::thread::hardware_concurrency() / 2));
+  const uint64_t num_pages = flags.GetInt("pages", 65536);
+  const uint64_t fetches_per_thread = flags.GetInt("fetches_per_thread", 200000);
+  const uint64_t seed = flags.GetInt("seed", 42);
+  const int num_nodes = bustub::NumaUtil::NumNodes();
+
+  printf("threads=%lu pages=%lu fetches_per_thread=%lu numa_nodes=%d%s\n", threads, num_pages, fetches_per_thread,
+         num_nodes, bustub::NumaUtil::IsAvailable() ? "" : " (NUMA not available, binding is a no-op)");
+  printf("%-10s %6s %16s %12s\n", "placement", "node", "fetches/s", "GB/s");
+  bustub::RunPlacement("local", 0, threads, num_pages, fetches_per_thread, seed);
+  bustub::RunPlacement("remote", num_nodes - 1, threads, num_pages, fetches_per_thread, seed);
+  return 0;
+}
@@ -0,0 +1,72 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// parallel_new_page_bench.cpp
+//
+// Identification: tools/buffer/parallel_new_page_bench.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+// Allocation-heavy insert load: every thread creates pages with NewPage and unpins them right away, against a
+// ParallelBufferPoolManager with an increasing number of instances. The new pages are clean, so eviction does no I/O
+// and the benchmark measures how well allocations spread over the instances' latches.
+//
+// Flags: --threads, --pages_per_thread, --pool_size (frames per instance), --max_instances
+
+#include <cstdio>
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "benchmark/benchmark_util.h"
+#include "buffer/parallel_buffer_pool_manager.h"
+
+int main(int argc, char **argv) {
+  bustub::BenchmarkFlags flags(argc, argv);
+  const uint64_t threads = flags.GetInt("threads", std::max(2U, std::thread::hardware_concurrency()));
+  const uint64_t pages_per_thread = flags.GetInt("pages_per_thread", 100000);
+  const uint64_t pool_size = flags.GetInt("pool_size", 256);
+  const uint64_t max_instances = flags.GetInt("max_instances", 16);
+  const std::string db_name = "parallel_new_page_bench.db";
+
+  printf("threads=%lu pages_per_thread=%lu pool_size=%lu\n", threads, pages_per_thread, pool_size);
+  printf("%-10s %-12s %16s\n", "instances", "start", "new pages/s");
+
+  for (uint64_t instances = 1; instances <= max_instances; instances *= 2) {
+    for (bool affinity : {false, true}) {
+      auto *disk_manager = new bustub::DiskManager(db_name);
+      bustub::BufferPoolOptions options;
+      options.new_page_thread_affinity_ = affinity;
+      auto *bpm = new bustub::ParallelBufferPoolManager(instances, pool_size, disk_manager, nullptr, options);
+
+      auto start = std::chrono::steady_clock::now();
+      std::vector<std::thread> workers;
+      for (uint64_t t = 0; t < threads; t++) {
+        workers.emplace_back([bpm, pages_per_thread] {
+          for (uint64_t i = 0; i < pages_per_thread; i++) {
+            bustub::page_id_t page_id;
+            if (bpm->NewPage(&page_id) != nullptr) {
+              bpm->UnpinPage(page_id, false);
+            }
+          }
+        });
+      }
+      for (auto &worker : workers) {
+        worker.join();
+      }
+      double seconds = bustub::SecondsSince(start);
+      printf("%-10lu %-12s %16.0f\n", instances, affinity ? "affinity" : "round-robin",
+             threads * pages_per_thread / seconds);
+
+      delete bpm;
+      disk_manager->ShutDown();
+      delete disk_manager;
+      remove(db_name.c_str());
+      remove("parallel_new_page_bench.log");
+    }
+  }
+  return 0;
+}
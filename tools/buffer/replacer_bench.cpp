@@ -0,0 +1,159 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// replacer_bench.cpp
+//
+// Identification: tools/buffer/replacer_bench.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+// Replays a mix of Zipfian point reads (index pages) and periodic full scans (table pages) against each replacement
+// policy and reports the hit ratio. Pages are not read from disk; the benchmark only drives the Replacer interface
+// the way BufferPoolManagerInstance does, so it measures the policy and not the I/O.
+//
+// Flags: --frames, --index_pages, --table_pages, --point_reads, --scan_every, --tuples_per_page, --theta, --seed
+
+#include <cstdio>
+#include <list>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "benchmark/benchmark_util.h"
+#include "buffer/clock_replacer.h"
+#include "buffer/lru_k_replacer.h"
+#include "buffer/lru_replacer.h"
+
+namespace bustub {
+
+/** CacheSimulator tracks which page sits in which frame and asks the replacer for victims on a miss. */
+class CacheSimulator {
+ public:
+  CacheSimulator(std::unique_ptr<Replacer> replacer, size_t num_frames)
+      : replacer_(std::move(replacer)), frame_to_page_(num_frames, INVALID_PAGE_ID) {
+    for (size_t i = 0; i < num_frames; i++) {
+      free_list_.push_back(static_cast<frame_id_t>(i));
+    }
+  }
+
+  /**
+   * Reference a page refs times in a row, like a scan fetching the page once per tuple.
+   * @return true if the first reference was a hit
+   */
+  bool Access(page_id_t page_id, size_t refs) {
+    bool hit = true;
+    auto iter = page_table_.find(page_id);
+    frame_id_t frame;
+    if (iter != page_table_.end()) {
+      frame = iter->second;
+    } else {
+      hit = false;
+      if (!free_list_.empty()) {
+        frame = free_list_.front();
+        free_list_.pop_front();
+      } else {
+        replacer_->Victim(&frame);
+        page_table_.erase(frame_to_page_[frame]);
+      }
+      frame_to_page_[frame] = page_id;
+      page_table_[page_id] = frame;
+      replacer_->SetPage(frame, page_id, false);
+    }
+    for (size_t i = 0; i < refs; i++) {
+      replacer_->Pin(frame);
+      replacer_->Unpin(frame);
+    }
+    return hit;
+  }
+
+ private:
+  std::unique_ptr<Replacer> replacer_;
+  std::unordered_map<page_id_t, frame_id_t> page_table_;
+  std::vector<page_id_t> frame_to_page_;
+  std::list<frame_id_t> free_list_;
+};
+
+/**
+ * LRUKReplacer on the simulator's clock, which advances one tick per reference, so that the correlated reference
+ * period does not depend on how fast the simulation runs.
+ */
+class SimulatedLRUKReplacer : public LRUKReplacer {
+ public:
+  SimulatedLRUKReplacer(size_t num_pages, size_t k, uint64_t correlated_refs)
+      : LRUKReplacer(num_pages, k, std::chrono::nanoseconds(correlated_refs)) {}
+
+ protected:
+  std::chrono::steady_clock::time_point Now() const override {
+    return std::chrono::steady_clock::time_point(std::chrono::nanoseconds(++ticks_));
+  }
+
+ private:
+  mutable uint64_t ticks_{0};
+};
+
+struct Policy {
+  std::string name_;
+  std::unique_ptr<Replacer> (*make_)(size_t num_frames, size_t tuples_per_page);
+};
+
+}  // namespace bustub
+
+int main(int argc, char **argv) {
+  using bustub::Replacer;
+  bustub::BenchmarkFlags flags(argc, argv);
+  const uint64_t frames = flags.GetInt("frames", 1000);
+  const uint64_t index_pages = flags.GetInt("index_pages", 2000);
+  const uint64_t table_pages = flags.GetInt("table_pages", 20000);
+  const uint64_t point_reads = flags.GetInt("point_reads", 400000);
+  const uint64_t scan_every = flags.GetInt("scan_every", 50000);
+  const uint64_t tuples_per_page = flags.GetInt("tuples_per_page", 8);
+  const double theta = flags.GetDouble("theta", 0.9);
+  const uint64_t seed = flags.GetInt("seed", 15445);
+
+  std::vector<bustub::Policy> policies = {
+      {"LRU", [](size_t n, size_t) -> std::unique_ptr<Replacer> { return std::make_unique<bustub::LRUReplacer>(n); }},
+      {"CLOCK",
+       [](size_t n, size_t) -> std::unique_ptr<Replacer> { return std::make_unique<bustub::ClockReplacer>(n); }},
+      {"LRU-2", [](size_t n, size_t) -> std::unique_ptr<Replacer> {
+         return std::make_unique<bustub::LRUKReplacer>(n, 2, std::chrono::nanoseconds(0));
+       }},
+      {"LRU-2/correlated", [](size_t n, size_t tuples) -> std::unique_ptr<Replacer> {
+         return std::make_unique<bustub::SimulatedLRUKReplacer>(n, 2, tuples);
+       }},
+  };
+
+  printf("frames=%lu index_pages=%lu table_pages=%lu point_reads=%lu scan_every=%lu tuples_per_page=%lu theta=%.2f\n",
+         frames, index_pages, table_pages, point_reads, scan_every, tuples_per_page, theta);
+  printf("%-18s %14s %14s %10s\n", "policy", "point hit %", "overall hit %", "seconds");
+
+  for (const auto &policy : policies) {
+    bustub::CacheSimulator sim(policy.make_(frames, tuples_per_page), frames);
+    bustub::ZipfianGenerator zipf(index_pages, theta);
+    std::mt19937_64 rng(seed);
+    uint64_t point_hits = 0;
+    uint64_t hits = 0;
+    uint64_t accesses = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (uint64_t i = 0; i < point_reads; i++) {
+      if (scan_every != 0 && i % scan_every == 0) {
+        for (uint64_t p = 0; p < table_pages; p++) {
+          hits += sim.Access(static_cast<bustub::page_id_t>(index_pages + p), tuples_per_page) ? 1 : 0;
+          accesses++;
+        }
+      }
+      bool hit = sim.Access(static_cast<bustub::page_id_t>(zipf.Next(&rng)), 1);
+      point_hits += hit ? 1 : 0;
+      hits += hit ? 1 : 0;
+      accesses++;
+    }
+    double seconds = bustub::SecondsSince(start);
+    printf("%-18s %14.2f %14.2f %10.3f\n", policy.name_.c_str(), 100.0 * point_hits / point_reads,
+           100.0 * hits / accesses, seconds);
+  }
+  return 0;
+}
@@ -0,0 +1,139 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// rwlatch_bench.cpp
+//
+// Identification: tools/common/rwlatch_bench.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+// Reader scalability of ReaderWriterLatch against std::shared_mutex and the mutex/condition-variable latch it
+// replaced. Every thread repeatedly takes the read latch of one shared latch, reads a few words and releases it;
+// a --write_pct share of the operations take the write latch instead.
+//
+// Flags: --max_threads, --ops_per_thread, --write_pct
+
+#include <condition_variable>  // NOLINT
+#include <cstdio>
+#include <mutex>         // NOLINT
+#include <shared_mutex>  // NOLINT
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "benchmark/benchmark_util.h"
+#include "common/rwlatch.h"
+
+namespace {
+
+/** The previous ReaderWriterLatch: every operation takes a std::mutex. */
+class MutexReaderWriterLatch {
+ public:
+  void WLock() {
+    std::unique_lock<std::mutex> latch(mutex_);
+    while (writer_entered_) {
+      reader_.wait(latch);
+    }
+    writer_entered_ = true;
+    while (reader_count_ > 0) {
+      writer_.wait(latch);
+    }
+  }
+
+  void WUnlock() {
+    std::lock_guard<std::mutex> guard(mutex_);
+    writer_entered_ = false;
+    reader_.notify_all();
+  }
+
+  void RLock() {
+    std::unique_lock<std::mutex> latch(mutex_);
+    while (writer_entered_) {
+      reader_.wait(latch);
+    }
+    reader_count_++;
+  }
+
+  void RUnlock() {
+    std::lock_guard<std::mutex> guard(mutex_);
+    reader_count_--;
+    if (writer_entered_ && reader_count_ == 0) {
+      writer_.notify_one();
+    }
+  }
+
+ private:
+  std::mutex mutex_;
+  std::condition_variable writer_;
+  std::condition_variable reader_;
+  uint32_t reader_count_{0};
+  bool writer_entered_{false};
+};
+
+/** std::shared_mutex behind the ReaderWriterLatch interface. */
+class SharedMutexLatch {
+ public:
+  void WLock() { mutex_.lock(); }
+  void WUnlock() { mutex_.unlock(); }
+  void RLock() { mutex_.lock_shared(); }
+  void RUnlock() { mutex_.unlock_shared(); }
+
+ private:
+  std::shared_mutex mutex_;
+};
+
+/** @return operations per second of threads hammering one Latch */
+template <typename Latch>
+double Run(uint64_t threads, uint64_t ops_per_thread, uint64_t write_pct) {
+  Latch latch;
+  uint64_t words[8] = {};
+  auto start = std::chrono::steady_clock::now();
+  std::vector<std::thread> workers;
+  for (uint64_t t = 0; t < threads; t++) {
+    workers.emplace_back([&] {
+      uint64_t sum = 0;
+      for (uint64_t i = 0; i < ops_per_thread; i++) {
+        if (i % 100 < write_pct) {
+          latch.WLock();
+          words[i % 8]++;
+          latch.WUnlock();
+        } else {
+          latch.RLock();
+          for (auto word : words) {
+            sum += word;
+          }
+          latch.RUnlock();
+        }
+      }
+      asm volatile("" : : "r"(sum));
+    });
+  }
+  for (auto &worker : workers) {
+    worker.join();
+  }
+  return threads * ops_per_thread / bustub::SecondsSince(start);
+}
+
+}  // namespace
+
+int main(int argc, char **argv) {
+  bustub::BenchmarkFlags flags(argc, argv);
+  const uint64_t max_threads = flags.GetInt("max_threads", 64);
+  const uint64_t ops_per_thread = flags.GetInt("ops_per_thread", 1000000);
+  const uint64_t write_pct = flags.GetInt("write_pct", 0);
+
+  printf("ops_per_thread=%lu write_pct=%lu sizeof(ReaderWriterLatch)=%zu\n", ops_per_thread, write_pct,
+         sizeof(bustub::ReaderWriterLatch));
+  printf("%-8s %18s %18s %18s\n", "threads", "ReaderWriterLatch", "shared_mutex", "mutex+condvar");
+
+  for (uint64_t threads = 1; threads <= max_threads; threads *= 2) {
+    double latch = Run<bustub::ReaderWriterLatch>(threads, ops_per_thread, write_pct);
+    double shared = Run<SharedMutexLatch>(threads, ops_per_thread, write_pct);
+    double mutex = Run<MutexReaderWriterLatch>(threads, ops_per_thread, write_pct);
+    printf("%-8lu %18.0f %18.0f %18.0f\n", threads, latch, shared, mutex);
+  }
+  return 0;
+}
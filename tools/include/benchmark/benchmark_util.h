@@ -0,0 +1,98 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// benchmark_util.h
+//
+// Identification: tools/include/benchmark/benchmark_util.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <algorithm>
+#include <chrono>  // NOLINT
+#include <cmath>
+#include <cstdint>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace bustub {
+
+/**
+ * BenchmarkFlags parses "--name=value" command line arguments. Unknown flags are ignored, missing flags fall back to
+ * the default passed by the caller.
+ */
+class BenchmarkFlags {
+ public:
+  BenchmarkFlags(int argc, char **argv) {
+    for (int i = 1; i < argc; i++) {
+      std::string arg(argv[i]);
+      if (arg.rfind("--", 0) != 0) {
+        continue;
+      }
+      auto eq = arg.find('=');
+      if (eq == std::string::npos) {
+        flags_[arg.substr(2)] = "1";
+      } else {
+        flags_[arg.substr(2, eq - 2)] = arg.substr(eq + 1);
+      }
+    }
+  }
+
+  uint64_t GetInt(const std::string &name, uint64_t default_value) const {
+    auto iter = flags_.find(name);
+    return iter == flags_.end() ? default_value : std::stoull(iter->second);
+  }
+
+  double GetDouble(const std::string &name, double default_value) const {
+    auto iter = flags_.find(name);
+    return iter == flags_.end() ? default_value : std::stod(iter->second);
+  }
+
+  std::string GetString(const std::string &name, const std::string &default_value) const {
+    auto iter = flags_.find(name);
+    return iter == flags_.end() ? default_value : iter->second;
+  }
+
+ private:
+  std::unordered_map<std::string, std::string> flags_;
+};
+
+/**
+ * ZipfianGenerator draws integers in [0, n) where the probability of i is proportional to 1 / (i + 1)^theta.
+ */
+class ZipfianGenerator {
+ public:
+  ZipfianGenerator(uint64_t n, double theta) : cdf_(n) {
+    double sum = 0;
+    for (uint64_t i = 0; i < n; i++) {
+      sum += 1.0 / std::pow(static_cast<double>(i + 1), theta);
+      cdf_[i] = sum;
+    }
+    for (auto &value : cdf_) {
+      value /= sum;
+    }
+  }
+
+  template <typename Engine>
+  uint64_t Next(Engine *rng) {
+    double u = dist_(*rng);
+    return std::min<uint64_t>(std::lower_bound(cdf_.begin(), cdf_.end(), u) - cdf_.begin(), cdf_.size() - 1);
+  }
+
+ private:
+  std::vector<double> cdf_;
+  std::uniform_real_distribution<double> dist_{0.0, 1.0};
+};
+
+/** @return seconds elapsed since start */
+inline double SecondsSince(std::chrono::steady_clock::time_point start) {
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+}  // namespace bustub
@@ -0,0 +1,119 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// disk_read_bench.cpp
+//
+// Identification: tools/storage/disk_read_bench.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+// Uniformly random page reads of a database file from 1, 2, 4, ... --threads threads, through one DiskManager.
+//   latched  every read holds one shared mutex, as when ReadPage seeked and read a shared file stream
+//   pread    ReadPage as is, positional reads that share no cursor and take no latch
+//   async    each thread keeps --batch reads in flight through SubmitRequests (io_uring or its thread pool)
+//
+// The file is freshly written, so reads are served from the operating system's page cache and measure the system
+// call path rather than the device. Scaling is bounded by the number of cores.
+//
+// Flags: --threads (most threads), --pages, --reads (per thread), --batch, --seed
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <future>  // NOLINT
+#include <mutex>   // NOLINT
+#include <random>
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "benchmark/benchmark_util.h"
+#include "storage/disk/disk_manager.h"
+
+namespace bustub {
+
+enum class ReadMode { LATCHED, PREAD, ASYNC };
+
+/** Read reads random pages from each of threads threads and return the pages read per second. */
+static double RunReads(DiskManager *disk_manager, ReadMode mode, uint64_t threads, uint64_t num_pages, uint64_t reads,
+                       uint64_t batch, uint64_t seed) {
+  std::mutex latch;
+  auto start = std::chrono::steady_clock::now();
+  std::vector<std::thread> workers;
+  for (uint64_t t = 0; t < threads; t++) {
+    workers.emplace_back([&, t] {
+      std::mt19937_64 rng(seed + t);
+      std::vector<char> bufs(batch * PAGE_SIZE);
+      for (uint64_t i = 0; i < reads;) {
+        if (mode == ReadMode::ASYNC) {
+          std::vector<DiskRequest> requests(std::min(batch, reads - i));
+          std::vector<std::future<bool>> done;
+          for (size_t j = 0; j < requests.size(); j++) {
+            requests[j].page_id_ = static_cast<page_id_t>(rng() % num_pages);
+            requests[j].data_ = bufs.data() + j * PAGE_SIZE;
+            done.push_back(requests[j].callback_.get_future());
+          }
+          disk_manager->SubmitRequests(&requests);
+          for (auto &read : done) {
+            read.get();
+          }
+          i += done.size();
+          continue;
+        }
+        auto page_id = static_cast<page_id_t>(rng() % num_pages);
+        if (mode == ReadMode::LATCHED) {
+          std::scoped_lock lk{latch};
+          disk_manager->ReadPage(page_id, bufs.data());
+        } else {
+          disk_manager->ReadPage(page_id, bufs.data());
+        }
+        i++;
+      }
+    });
+  }
+  for (auto &worker : workers) {
+    worker.join();
+  }
+  return threads * reads / SecondsSince(start);
+}
+
+}  // namespace bustub
+
+int main(int argc, char **argv) {
+  bustub::BenchmarkFlags flags(argc, argv);
+  const uint64_t max_threads = flags.GetInt("threads", 8);
+  const uint64_t num_pages = flags.GetInt("pages", 16384);
+  const uint64_t reads = flags.GetInt("reads", 50000);
+  const uint64_t batch = flags.GetInt("batch", 32);
+  const uint64_t seed = flags.GetInt("seed", 42);
+  const std::string db_name = "disk_read_bench.db";
+
+  bustub::DiskManagerOptions options;
+  options.async_io_ = true;
+  options.io_queue_depth_ = 256;
+  // SubmitRequests needs the asynchronous backend, ReadPage is measured on a synchronous DiskManager
+  bustub::DiskManager sync_dm(db_name);
+  std::vector<char> page(bustub::PAGE_SIZE);
+  for (uint64_t i = 0; i < num_pages; i++) {
+    snprintf(page.data(), page.size(), "page %lu", i);
+    sync_dm.WritePage(static_cast<bustub::page_id_t>(i), page.data());
+  }
+  bustub::DiskManager async_dm(db_name, options);
+
+  printf("pages=%lu reads=%lu batch=%lu\n", num_pages, reads, batch);
+  printf("%8s %14s %14s %14s\n", "threads", "latched/s", "pread/s", "async/s");
+  for (uint64_t threads = 1; threads <= max_threads; threads *= 2) {
+    double latched = RunReads(&sync_dm, bustub::ReadMode::LATCHED, threads, num_pages, reads, batch, seed);
+    double pread = RunReads(&sync_dm, bustub::ReadMode::PREAD, threads, num_pages, reads, batch, seed);
+    double async = RunReads(&async_dm, bustub::ReadMode::ASYNC, threads, num_pages, reads, batch, seed);
+    printf("%8lu %14.0f %14.0f %14.0f\n", threads, latched, pread, async);
+  }
+  async_dm.ShutDown();
+  sync_dm.ShutDown();
+  remove(db_name.c_str());
+  remove("disk_read_bench.log");
+  return 0;
+}